@@ -0,0 +1,102 @@
+#include "Generator.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+CatalogShape::CatalogShape()
+        : movies(10000), series(1000), maxSeasons(8), maxEpisodes(24), tags(64), maxTags(4), lengthMean(90),
+          lengthDeviation(30), seed(42) {}
+
+WorkloadShape::WorkloadShape() : users(100), binges(10000), continuePercent(70), seed(7) {}
+
+static int drawLength(std::mt19937 &random, std::normal_distribution<double> &length) {
+    return std::max(1, static_cast<int>(length(random)));
+}
+
+static void writeTags(std::mt19937 &random, const CatalogShape &shape, std::ostream &output) {
+    std::uniform_int_distribution<int> count(1, std::min(shape.maxTags, shape.tags));
+    std::uniform_int_distribution<int> tag(0, shape.tags - 1);
+    std::vector<int> chosen;
+    int tagCount = count(random);
+    while (static_cast<int>(chosen.size()) < tagCount) {
+        int next = tag(random);
+        if (std::find(chosen.begin(), chosen.end(), next) == chosen.end()) {
+            chosen.push_back(next);
+        }
+    }
+    output << "\"tags\": [";
+    for (std::size_t i = 0; i < chosen.size(); i++) {
+        output << (i == 0 ? "" : ", ") << "\"Tag " << chosen[i] << "\"";
+    }
+    output << "]";
+}
+
+long writeCatalog(const CatalogShape &shape, std::ostream &output) {
+    std::mt19937 random(shape.seed);
+    std::normal_distribution<double> length(shape.lengthMean, shape.lengthDeviation);
+    std::uniform_int_distribution<int> seasons(1, shape.maxSeasons);
+    std::uniform_int_distribution<int> episodes(1, shape.maxEpisodes);
+    long ids = shape.movies;
+
+    output << "{\n  \"movies\": [\n";
+    for (long movie = 0; movie < shape.movies; movie++) {
+        output << "    {\"name\": \"Movie " << movie << "\", \"length\": " << drawLength(random, length) << ", ";
+        writeTags(random, shape, output);
+        output << (movie + 1 < shape.movies ? "},\n" : "}\n");
+    }
+    output << "  ],\n  \"tv_series\": [\n";
+    for (long series = 0; series < shape.series; series++) {
+        output << "    {\"name\": \"Series " << series << "\", \"episode_length\": " << drawLength(random, length)
+               << ", \"seasons\": [";
+        int seasonCount = seasons(random);
+        for (int season = 0; season < seasonCount; season++) {
+            int episodeCount = episodes(random);
+            ids += episodeCount;
+            output << (season == 0 ? "" : ", ") << episodeCount;
+        }
+        output << "], ";
+        writeTags(random, shape, output);
+        output << (series + 1 < shape.series ? "},\n" : "}\n");
+    }
+    output << "  ]\n}\n";
+    return ids;
+}
+
+long writeWorkload(const WorkloadShape &shape, long ids, std::ostream &output) {
+    static const char *algorithms[] = {"len", "rer", "gen"};
+    std::mt19937 random(shape.seed);
+    std::uniform_int_distribution<long> user(0, shape.users - 1);
+    std::uniform_int_distribution<long> id(1, ids);
+    std::uniform_int_distribution<int> percent(0, 99);
+    long lines = 0;
+
+    for (long created = 0; created < shape.users; created++) {
+        output << "createuser user" << created << " " << algorithms[created % 3] << "\n";
+        lines++;
+    }
+    for (long binge = 0; binge < shape.binges; binge++) {
+        output << "changeuser user" << user(random) << "\nwatch " << id(random) << "\n";
+        lines += 2;
+        //a binge watches at most 20 contents
+        for (int answer = 1; answer < 20 && percent(random) < shape.continuePercent; answer++) {
+            output << "y\n";
+            lines++;
+        }
+        output << "n\n";
+        lines++;
+        if (binge % 10 == 9) {
+            output << "watchhist\n";
+            lines++;
+        }
+        if (binge % 50 == 49) {
+            output << "dupuser user" << user(random) << " copy" << binge << "\n";
+            lines++;
+        }
+        if (binge % 100 == 99) {
+            output << "log tail 20\n";
+            lines++;
+        }
+    }
+    output << "exit\n";
+    return lines + 1;
+}
@@ -0,0 +1,51 @@
+#ifndef GENERATOR_H_
+#define GENERATOR_H_
+
+#include <ostream>
+#include <string>
+
+/**
+ * The size of a synthetic catalog. Lengths are drawn from a normal distribution (at least 1 minute),
+ * every content gets between 1 and maxTags distinct tags out of a vocabulary of tags tags.
+ */
+struct CatalogShape {
+    CatalogShape();
+
+    long movies;
+    long series;
+    int maxSeasons;
+    int maxEpisodes;
+    int tags;
+    int maxTags;
+    int lengthMean;
+    int lengthDeviation;
+    unsigned seed;
+};
+
+/**
+ * A synthetic command script: users of every algorithm that binge, duplicate each other and print their
+ * histories and the log.
+ */
+struct WorkloadShape {
+    WorkloadShape();
+
+    long users;
+    long binges;
+    //the chance to answer 'y' to a recommendation, in percent
+    int continuePercent;
+    unsigned seed;
+};
+
+/**
+ * Writes a catalog in the format of the config files.
+ * @return the amount of ids in the catalog (movies and episodes).
+ */
+long writeCatalog(const CatalogShape &shape, std::ostream &output);
+
+/**
+ * Writes a command script for a session over a catalog with the given amount of ids, see Main --script.
+ * @return the amount of commands and answers written.
+ */
+long writeWorkload(const WorkloadShape &shape, long ids, std::ostream &output);
+
+#endif
@@ -0,0 +1,94 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include "../include/Catalog.h"
+#include "../include/LengthKernel.h"
+#include "../include/WatchedSet.h"
+
+/**
+ * Compares the ways to find the content closest in length to an average for a user that watched a large
+ * part of the catalog: the length index, the scalar column scan and the LengthKernel levels.
+ *
+ * usage: lengthkernelbench [ids] [watched percent]
+ */
+
+/**
+ * The column scan before LengthKernel: one pass that checks every closer row against the watched set.
+ */
+static long referenceScan(const MappedArray<int> &lengths, int average, const WatchedSet &watched) {
+    long closest = -1;
+    long closestDistance = std::numeric_limits<long>::max();
+    for (std::size_t row = 0; row < lengths.size(); row++) {
+        long distance = std::labs(static_cast<long>(lengths[row]) - average);
+        if (distance < closestDistance && !watched.contains(static_cast<long>(row) + 1)) {
+            closest = static_cast<long>(row) + 1;
+            closestDistance = distance;
+        }
+    }
+    return closest;
+}
+
+template<typename Search>
+static void measure(const std::string &name, const std::vector<int> &averages, const std::vector<long> &expected,
+                    Search search) {
+    auto start = std::chrono::steady_clock::now();
+    bool same = true;
+    for (std::size_t i = 0; i < averages.size(); i++) {
+        same = search(averages[i]) == expected[i] && same;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": " << elapsed.count() / static_cast<long>(averages.size()) << " ns/op"
+              << (same ? "" : " (DIFFERENT RESULTS)") << std::endl;
+}
+
+int main(int argc, char **argv) {
+    long ids = argc > 1 ? std::atol(argv[1]) : 1000000;
+    int watchedPercent = argc > 2 ? std::atoi(argv[2]) : 60;
+
+    std::mt19937 random(42);
+    Catalog catalog;
+    std::uniform_int_distribution<int> length(1, 200);
+    for (long id = 1; id <= ids; id++) {
+        catalog.addMovie("movie " + std::to_string(id), length(random), {"tag"});
+    }
+    catalog.finish();
+
+    WatchedSet watched;
+    std::uniform_int_distribution<int> percent(0, 99);
+    for (long id = 1; id <= ids; id++) {
+        if (percent(random) < watchedPercent) {
+            watched.add(id);
+        }
+    }
+
+    std::vector<int> averages;
+    std::vector<long> expected;
+    const MappedArray<int> &lengths = catalog.getColumns().getLengths();
+    for (int i = 0; i < 50; i++) {
+        averages.push_back(length(random));
+        expected.push_back(referenceScan(lengths, averages.back(), watched));
+    }
+
+    std::cout << ids << " ids, " << watched.size() << " watched ("
+              << (watched.isDense() ? "bitmap" : "hash set") << "), best level "
+              << LengthKernel::levelName(LengthKernel::detect()) << std::endl;
+    if (catalog.isIndexed()) {
+        measure("length index", averages, expected, [&](int average) {
+            return catalog.getLengthIndex().findClosest(average, watched);
+        });
+    }
+    measure("column scan", averages, expected, [&](int average) {
+        return referenceScan(lengths, average, watched);
+    });
+    for (int level = LengthKernel::SCALAR; level <= LengthKernel::detect(); level++) {
+        auto kernelLevel = static_cast<LengthKernel::Level>(level);
+        measure(std::string("kernel ") + LengthKernel::levelName(kernelLevel), averages, expected,
+                [&](int average) {
+                    return LengthKernel::findClosest(lengths.data(), lengths.size(), average, watched.getBits(),
+                                                     kernelLevel);
+                });
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include "Generator.h"
+#include "../include/Action.h"
+#include "../include/Catalog.h"
+#include "../include/Session.h"
+#include "../include/ThreadPool.h"
+#include "../include/User.h"
+
+/**
+ * Generates a synthetic catalog and workload and measures the main operations of a session on them,
+ * reporting the time and the amount of heap allocations per operation.
+ *
+ * usage: splflixbench [--option value]...
+ *   catalog:  --movies --series --max-seasons --max-episodes --tags --max-tags --length-mean --length-deviation
+ *   workload: --users --binges --continue-percent
+ *   --ops (operations per micro benchmark), --seed, --catalog file, --workload file (where to write them)
+ *   --batch-users (users of the recommendall measurement)
+ *   --generate-only 1 writes the catalog and the workload without measuring, e.g. to replay them with
+ *   splflix catalog --script workload.
+ */
+
+//Allocation counting, every allocation of the program goes through these.
+//They are not inlined, so the compiler does not pair the malloc and free of an inlined new and delete.
+//The pool workers of recommendall allocate too, so every thread counts in a counter of its own cache line,
+//and allocations() sums them. Threads beyond MAX_COUNTERS share counters, which the atomics keep exact.
+struct alignas(64) AllocationCounter {
+    std::atomic<std::size_t> count;
+};
+
+static const unsigned MAX_COUNTERS = 256;
+static AllocationCounter counters[MAX_COUNTERS];
+static std::atomic<unsigned> nextCounter(0);
+static thread_local AllocationCounter *threadCounter = nullptr;
+
+static std::size_t allocations() {
+    std::size_t sum = 0;
+    for (const auto &counter : counters) {
+        sum += counter.count.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+__attribute__((noinline)) void *operator new(std::size_t size) {
+    if (!threadCounter) {
+        threadCounter = &counters[nextCounter.fetch_add(1, std::memory_order_relaxed) % MAX_COUNTERS];
+    }
+    threadCounter->count.fetch_add(1, std::memory_order_relaxed);
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+__attribute__((noinline)) void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+__attribute__((noinline)) void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+/**
+ * Drops the printed output so only the formatting is measured.
+ */
+class NullBuffer : public std::streambuf {
+protected:
+    virtual int overflow(int character) {
+        return character;
+    }
+
+    virtual std::streamsize xsputn(const char *, std::streamsize count) {
+        return count;
+    }
+};
+
+/**
+ * Runs operation ops times (operation gets the number of the run) and prints the time and the allocations
+ * per operation.
+ */
+static void measure(const std::string &name, long ops, const std::function<void(long)> &operation) {
+    std::size_t allocationsBefore = allocations();
+    auto start = std::chrono::steady_clock::now();
+    for (long op = 0; op < ops; op++) {
+        operation(op);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::size_t allocated = allocations() - allocationsBefore;
+    std::cerr << name << ": " << elapsed.count() / ops << " ns/op, "
+              << static_cast<double>(allocated) / static_cast<double>(ops) << " allocs/op (" << ops << " ops)"
+              << std::endl;
+}
+
+/**
+ * Creates a user that watched history random contents, without printing.
+ */
+template<typename UserType>
+static User *addUser(Session &sess, const std::string &name, long history, long ids, std::mt19937 &random) {
+    std::uniform_int_distribution<long> id(1, ids);
+    auto *user = new UserType(name);
+    for (long watched = 0; watched < history; watched++) {
+        user->addToHistory(sess.getWatchable(id(random)));
+    }
+    std::string userName = name;
+    sess.addUser(userName, user);
+    return user;
+}
+
+int main(int argc, char **argv) {
+    std::map<std::string, std::string> options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        options[std::string(argv[i]).substr(2)] = argv[i + 1];
+    }
+    auto option = [&](const std::string &name, long byDefault) {
+        auto found = options.find(name);
+        return found == options.end() ? byDefault : std::atol(found->second.c_str());
+    };
+
+    CatalogShape catalogShape;
+    catalogShape.movies = option("movies", catalogShape.movies);
+    catalogShape.series = option("series", catalogShape.series);
+    catalogShape.maxSeasons = static_cast<int>(option("max-seasons", catalogShape.maxSeasons));
+    catalogShape.maxEpisodes = static_cast<int>(option("max-episodes", catalogShape.maxEpisodes));
+    catalogShape.tags = static_cast<int>(option("tags", catalogShape.tags));
+    catalogShape.maxTags = static_cast<int>(option("max-tags", catalogShape.maxTags));
+    catalogShape.lengthMean = static_cast<int>(option("length-mean", catalogShape.lengthMean));
+    catalogShape.lengthDeviation = static_cast<int>(option("length-deviation", catalogShape.lengthDeviation));
+    catalogShape.seed = static_cast<unsigned>(option("seed", catalogShape.seed));
+    WorkloadShape workloadShape;
+    workloadShape.users = option("users", workloadShape.users);
+    workloadShape.binges = option("binges", workloadShape.binges);
+    workloadShape.continuePercent = static_cast<int>(option("continue-percent", workloadShape.continuePercent));
+    workloadShape.seed = catalogShape.seed + 1;
+    long ops = option("ops", 1000);
+    std::string catalogPath = options.count("catalog") ? options["catalog"] : "splflix-bench-catalog.json";
+    std::string workloadPath = options.count("workload") ? options["workload"] : "splflix-bench-workload.txt";
+
+    long ids;
+    long commands;
+    {
+        std::ofstream catalogFile(catalogPath);
+        std::ofstream workloadFile(workloadPath);
+        ids = writeCatalog(catalogShape, catalogFile);
+        commands = writeWorkload(workloadShape, ids, workloadFile);
+        if (!catalogFile || !workloadFile) {
+            std::cerr << "could not write " << catalogPath << " or " << workloadPath << std::endl;
+            return 1;
+        }
+    }
+    std::cerr << catalogPath << ": " << ids << " ids, " << workloadPath << ": " << commands << " lines" << std::endl;
+    if (option("generate-only", 0)) {
+        return 0;
+    }
+
+    NullBuffer nullBuffer;
+    std::streambuf *oldOutput = std::cout.rdbuf(&nullBuffer);
+    std::streambuf *oldInput = std::cin.rdbuf();
+    std::mt19937 random(catalogShape.seed);
+    std::uniform_int_distribution<long> id(1, ids);
+
+    std::shared_ptr<const Catalog> catalog;
+    measure("createContent", std::max(1L, ops / 200), [&](long) {
+        catalog = Session::createContent(catalogPath);
+    });
+
+    Session sess(catalog);
+    sess.setInteractive(false);
+    User *length = addUser<LengthRecommenderUser>(sess, "length", 100, ids, random);
+    User *rerun = addUser<RerunRecommenderUser>(sess, "rerun", 100, ids, random);
+    User *genre = addUser<GenreRecommenderUser>(sess, "genre", 100, ids, random);
+    //copies of a user start without cached recommendations, so every op on a fresh copy runs the recommender
+    std::vector<std::pair<std::string, User *>> recommenders = {{"len", length}, {"rer", rerun}, {"gen", genre}};
+    for (const auto &recommender : recommenders) {
+        std::vector<std::unique_ptr<User>> copies;
+        for (long op = 0; op < 2 * ops; op++) {
+            std::string name = recommender.second->getName() + std::to_string(op);
+            copies.emplace_back(recommender.second->clone(name));
+        }
+        measure(recommender.first + " recommendation uncached", ops, [&](long op) {
+            copies[op]->getRecommendation(sess);
+        });
+        measure(recommender.first + " top 10 uncached", ops, [&](long op) {
+            copies[ops + op]->getRecommendations(sess, 10);
+        });
+    }
+    //the first call computes the recommendations, the rest are served from the cache of the user
+    measure("len recommendation", ops, [&](long) { length->getRecommendation(sess); });
+    measure("rer recommendation", ops, [&](long) { rerun->getRecommendation(sess); });
+    measure("gen recommendation", ops, [&](long) { genre->getRecommendation(sess); });
+    measure("len top 10", ops, [&](long) { length->getRecommendations(sess, 10); });
+    measure("rer top 10", ops, [&](long) { rerun->getRecommendations(sess, 10); });
+    measure("gen top 10", ops, [&](long) { genre->getRecommendations(sess, 10); });
+
+    //a watch of a content and of its recommendation
+    std::string answers;
+    for (long op = 0; op < ops; op++) {
+        answers += "y\nn\n";
+    }
+    std::istringstream answerInput(answers);
+    std::cin.rdbuf(answerInput.rdbuf());
+    for (User *user : {length, rerun, genre}) {
+        sess.setActiveUser(user);
+        measure("Watch::act " + user->getName(), std::max(1L, ops / 3), [&](long) {
+            Watch watch(id(random));
+            watch.act(sess);
+            sess.addActionToLog(watch);
+        });
+    }
+    std::cin.rdbuf(oldInput);
+
+    std::vector<std::string> copyNames;
+    for (long op = 0; op < ops; op++) {
+        copyNames.push_back("copy" + std::to_string(op));
+    }
+    std::string genreName = genre->getName();
+    measure("dupuser", ops, [&](long op) {
+        DuplicateUser duplicate(genreName, copyNames[op]);
+        duplicate.act(sess);
+        sess.addActionToLog(duplicate);
+    });
+
+    sess.setActiveUser(genre);
+    measure("content", std::max(1L, ops / 100), [&](long) {
+        PrintContentList printContent;
+        printContent.act(sess);
+    });
+    measure("watchhist", ops, [&](long) {
+        PrintWatchHistory printHistory;
+        printHistory.act(sess);
+    });
+    measure("log", std::max(1L, ops / 100), [&](long) {
+        PrintActionsLog printLog;
+        printLog.act(sess);
+    });
+
+    //the recommendations of all the users, on a single thread and on all the cores. Copies of the users start
+    //without cached recommendations, so every run computes all of them
+    Session batch(catalog);
+    long batchUsers = option("batch-users", 30000);
+    for (long user = 0; user < batchUsers; user++) {
+        std::string name = "batch" + std::to_string(user);
+        if (user % 3 == 0) {
+            addUser<LengthRecommenderUser>(batch, name, 20, ids, random);
+        } else if (user % 3 == 1) {
+            addUser<RerunRecommenderUser>(batch, name, 20, ids, random);
+        } else {
+            addUser<GenreRecommenderUser>(batch, name, 20, ids, random);
+        }
+    }
+    for (std::size_t threads : {static_cast<std::size_t>(1), ThreadPool::shared().size()}) {
+        ThreadPool pool(threads);
+        Session cold(batch);
+        measure("recommendall " + std::to_string(threads) + " threads, " + std::to_string(batchUsers) + " users", 1,
+                [&](long) { cold.getAllRecommendations(pool); });
+    }
+
+    //the whole workload through the line driven session, per command or answer
+    std::ifstream workload(workloadPath);
+    std::cin.rdbuf(workload.rdbuf());
+    Session replay(catalog);
+    replay.setInteractive(false);
+    replay.begin();
+    measure("workload line", commands, [&](long) { replay.step(); });
+    std::cin.rdbuf(oldInput);
+    std::cout.rdbuf(oldOutput);
+    return 0;
+}
@@ -4,13 +4,10 @@
 #include <string>
 #include <iostream>
 #include "User.h"
+#include "ActionLog.h"
 
 class Session;
 
-enum ActionStatus {
-    PENDING, COMPLETED, ERROR
-};
-
 class BaseAction {
 public:
     BaseAction();
@@ -31,6 +28,13 @@ public:
      */
     virtual BaseAction *clone() = 0;
 
+    /**
+     * @return the compact form of this action for the actions log, see ActionLog.
+     */
+    virtual ActionRecord toRecord(StringPool &strings) const = 0;
+
+    virtual ActionType getType() const = 0;
+
 protected:
     /**
      * Sets the status of an action to COMPLETED.
@@ -48,6 +52,9 @@ protected:
     void setErrorMsg(std::string &errorMsg);
 
 private:
+    //restores the status of the actions it describes
+    friend class ActionLog;
+
     std::string errorMsg;
     ActionStatus status;
 };
@@ -67,6 +74,10 @@ public:
 
     virtual BaseAction *clone();
 
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+
 private:
     std::string userName;
     std::string algorithmType;
@@ -86,6 +97,10 @@ public:
 
     virtual BaseAction *clone();
 
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+
 private:
     std::string userName;
 };
@@ -104,6 +119,10 @@ public:
 
     virtual BaseAction *clone();
 
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+
 private:
     std::string userName;
 };
@@ -123,6 +142,10 @@ public:
 
     virtual BaseAction *clone();
 
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+
 private:
     std::string oldUserName;
     std::string newUserName;
@@ -141,6 +164,10 @@ public:
     virtual std::string toString() const;
 
     virtual BaseAction *clone();
+
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
 };
 
 class PrintWatchHistory : public BaseAction {
@@ -152,38 +179,87 @@ public:
     virtual std::string toString() const;
 
     virtual BaseAction *clone();
+
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
 };
 
+/**
+ * A binge: watches the content with the given id, then keeps watching the recommendation of every watched
+ * content for as long as the user answers 'y'. The whole binge is a single action in the actions log.
+ */
 class Watch : public BaseAction {
 public:
     Watch(long id);
 
+    /**
+     * A finished binge of the given amount of content that ended with the content with the given id,
+     * as it is kept in the actions log.
+     */
+    Watch(long id, int steps);
+
+    /**
+     * Runs the whole binge, reading the answers to the recommendations from the input.
+     * @param sess the session in which to watch.
+     */
     virtual void act(Session &sess);
 
-    virtual std::string toString() const;
+    /**
+     * Watches the content with the id given on construction and asks whether to continue with its recommendation.
+     */
+    void begin(Session &sess);
 
-    bool getKeepWatching() const;
+    /**
+     * @return true while the binge waits for an answer to a recommendation.
+     */
+    bool isWaitingForAnswer() const;
 
-    long getNextId() const;
+    /**
+     * Continues the binge with the answer to the last recommendation: 'y' watches it, 'n' ends the binge
+     * and anything else ends it with an error.
+     */
+    void answer(Session &sess, const std::string &answer);
 
-    void setNextId(long newNextId);
+    /**
+     * One line per watched content, as if every step of the binge was a separate action.
+     */
+    virtual std::string toString() const;
 
     virtual BaseAction *clone();
 
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+
 private:
     long id;
-    long nextId;
-    bool keepWatching;
+    //the amount of content watched in the binge
+    int steps;
+    //the id of the recommendation computed for the last watched content while waiting for an answer, otherwise -1
+    long recommendationId;
+    //the id of the last watched content, the id to watch until the binge starts
+    long lastId;
 
-    void newRecommendation(Session &sess, Watchable *const watched);
+    /**
+     * Watches the content, computes its recommendation and prompts for it.
+     */
+    void watchNext(Session &sess, Watchable *watchable);
 };
 
 class PrintActionsLog : public BaseAction {
 public:
+    //prints the whole log
     PrintActionsLog();
 
     /**
-     * prints the actions performed in the session
+     * prints count records of the log starting at offset, 0 is the oldest record kept.
+     */
+    PrintActionsLog(std::size_t offset, std::size_t count);
+
+    /**
+     * prints the actions performed in the session, one record at a time.
+     * Fails if the offset is past the end of the log, prints nothing if it is at the end.
      * @param sess
      */
     virtual void act(Session &sess);
@@ -191,6 +267,14 @@ public:
     virtual std::string toString() const;
 
     virtual BaseAction *clone();
+
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+
+private:
+    std::size_t offset;
+    std::size_t count;
 };
 
 class Exit : public BaseAction {
@@ -206,6 +290,57 @@ public:
     virtual std::string toString() const;
 
     virtual BaseAction *clone();
+
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+};
+
+class Recommend : public BaseAction {
+public:
+    Recommend(std::size_t k);
+
+    /**
+     * prints up to k recommendations for the active user, best first, in the format of the content list.
+     * Fails if there is nothing to recommend.
+     * @param sess
+     */
+    virtual void act(Session &sess);
+
+    virtual std::string toString() const;
+
+    virtual BaseAction *clone();
+
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+
+private:
+    std::size_t k;
+};
+
+class RecommendAll : public BaseAction {
+public:
+    RecommendAll(const std::string &path);
+
+    /**
+     * Writes the recommendation of every user to the file at path, computed in parallel, a line per user
+     * ordered by name: the name and the id of the recommended content, or '-' if there is none.
+     * Fails if the file cannot be written.
+     * @param sess
+     */
+    virtual void act(Session &sess);
+
+    virtual std::string toString() const;
+
+    virtual BaseAction *clone();
+
+    virtual ActionRecord toRecord(StringPool &strings) const;
+
+    virtual ActionType getType() const;
+
+private:
+    std::string path;
 };
 
 #endif
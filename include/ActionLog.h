@@ -0,0 +1,182 @@
+#ifndef ACTION_LOG_H_
+#define ACTION_LOG_H_
+
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class BaseAction;
+
+enum ActionStatus {
+    PENDING, COMPLETED, ERROR
+};
+
+enum ActionType : std::uint8_t {
+    CREATE_USER, CHANGE_ACTIVE_USER, DELETE_USER, DUPLICATE_USER, PRINT_CONTENT_LIST, PRINT_WATCH_HISTORY,
+    PRINT_ACTIONS_LOG, WATCH, EXIT, RECOMMEND, RECOMMEND_ALL
+};
+
+static const int ACTION_TYPES = RECOMMEND_ALL + 1;
+
+/**
+ * The command of every action type, in the order of ActionType. The session registers its built in commands
+ * from this table and ActionStats names the types by it, so a new action type is only named here.
+ */
+static constexpr const char *ACTION_COMMANDS[] = {"createuser", "changeuser", "deleteuser", "dupuser", "content",
+                                                  "watchhist", "log", "watch", "exit", "recommend", "recommendall"};
+
+static_assert(sizeof(ACTION_COMMANDS) / sizeof(ACTION_COMMANDS[0]) == ACTION_TYPES,
+              "a command for every action type");
+
+/**
+ * Keeps every distinct string once and refers to it by a 32 bit id.
+ * Every intern of a string is a reference to it that is dropped by release. A string without references is
+ * removed and its id is reused, so the pool only holds the strings of the records that are kept.
+ */
+class StringPool {
+public:
+    StringPool();
+
+    /**
+     * @return the id of the value, with one more reference to it.
+     */
+    std::uint32_t intern(const std::string &value);
+
+    /**
+     * Drops a reference to the string with the id, the string is removed once it has none.
+     */
+    void release(std::uint32_t id);
+
+    std::string const &get(std::uint32_t id) const;
+
+    /**
+     * @return the amount of ids, in use or free to reuse, which bounds the memory of the pool.
+     */
+    std::size_t size() const;
+
+private:
+    struct Entry {
+        std::string value;
+        std::uint32_t references;
+    };
+
+    std::unordered_map<std::string, std::uint32_t> ids;
+    std::vector<Entry> entries;
+    //the ids of removed strings
+    std::vector<std::uint32_t> freeIds;
+};
+
+/**
+ * A finished action in 16 bytes: its type, its status and its arguments.
+ * User names, algorithms and paths are ids in the StringPool of the log, a watch keeps the amount of content it watched
+ * and the id of the last one, a recommend keeps its amount of recommendations.
+ */
+struct ActionRecord {
+    ActionType type;
+    std::uint8_t status;
+    std::uint32_t first;
+    std::uint64_t second;
+};
+
+/**
+ * The actions log of a session, kept as ActionRecords instead of action objects.
+ * The log is unbounded by default. With a capacity it becomes a ring buffer that keeps the newest records,
+ * and the evicted records are appended (as the lines of the `log` command) to a spill file if one is set.
+ * The strings of evicted records are released, so a bounded log takes bounded memory.
+ */
+class ActionLog {
+public:
+    static const std::size_t UNBOUNDED = 0;
+
+    ActionLog();
+
+    //Copies the records and the capacity, a copy does not spill.
+    ActionLog(const ActionLog &other);
+
+    ActionLog &operator=(const ActionLog &other);
+
+    ActionLog(ActionLog &&other);
+
+    ActionLog &operator=(ActionLog &&other);
+
+    ~ActionLog();
+
+    /**
+     * Keeps at most capacity records (UNBOUNDED for all of them), the oldest records are evicted first.
+     */
+    void setCapacity(std::size_t capacity);
+
+    /**
+     * Appends the evicted records to the given file.
+     * @return false if the file could not be opened.
+     */
+    bool setSpillPath(const std::string &path);
+
+    void add(const BaseAction &action);
+
+    /**
+     * @return the amount of records kept.
+     */
+    std::size_t size() const;
+
+    /**
+     * @return the record at the given position, 0 is the oldest record kept.
+     */
+    ActionRecord const &at(std::size_t position) const;
+
+    /**
+     * Appends the description of the record at the given position to output, in the format of the action's
+     * toString, followed by a new line.
+     */
+    void appendLine(std::string &output, std::size_t position) const;
+
+    /**
+     * Writes count records starting at the given position (fewer if the log ends before) to output, one line
+     * at a time, so only a single line is ever built in memory.
+     */
+    void write(std::ostream &output, std::size_t position, std::size_t count) const;
+
+    std::string toString() const;
+
+    StringPool const &getStrings() const;
+
+    void clear();
+
+private:
+    void copy(const ActionLog &other);
+
+    void move(ActionLog &&other);
+
+    void appendRecord(std::string &output, const ActionRecord &record) const;
+
+    /**
+     * Describes a recorded action by restoring it on the stack, so the log prints exactly what the action's
+     * toString prints.
+     */
+    static std::string describe(BaseAction &&action, ActionStatus status);
+
+    /**
+     * Spills the record and releases its strings.
+     */
+    void evict(const ActionRecord &record);
+
+    void spill(const ActionRecord &record);
+
+    //whether the first and the second argument of a record of the type are ids in strings
+    static bool hasFirstString(ActionType type);
+
+    static bool hasSecondString(ActionType type);
+
+    StringPool strings;
+    std::vector<ActionRecord> records;
+    //the position of the oldest record once the ring is full
+    std::size_t head;
+    std::size_t capacity;
+    std::unique_ptr<std::ofstream> spillFile;
+};
+
+#endif
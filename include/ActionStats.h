@@ -0,0 +1,70 @@
+#ifndef ACTION_STATS_H_
+#define ACTION_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "ActionLog.h"
+
+/**
+ * Counts the actions of every type and their latencies, from the command to the action being logged.
+ * Latencies are measured in ticks of now() and kept in histograms of power of two buckets: bucket b holds
+ * [2^(b-1), 2^b) ticks. They are converted to nanoseconds only by toString.
+ * Every thread records into its own block of relaxed atomic counters, created on its first action and kept
+ * after it exits, so recording takes no lock and toString can read all the blocks at any time.
+ */
+class ActionStats {
+public:
+    static const int TYPES = ACTION_TYPES;
+    static const int BUCKETS = 64;
+
+    /**
+     * Stats are recorded unless disabled, e.g. by the --stats off option.
+     */
+    static void setEnabled(bool enabled);
+
+    static bool isEnabled();
+
+    /**
+     * @return the time stamp counter of the cpu on x86, which is cheaper to read than the steady clock,
+     * otherwise the steady clock in nanoseconds.
+     */
+    static std::uint64_t now();
+
+    /**
+     * @param ticks the latency of the action, a difference of now() values.
+     */
+    static void record(ActionType type, std::uint64_t ticks);
+
+    /**
+     * @return a line for every action type that was recorded: its count, the p50, p99 and p999 latencies
+     * (upper bounds of their buckets) and the maximal latency, summed over all the threads. Empty if nothing
+     * was recorded.
+     */
+    static std::string toString();
+
+    /**
+     * @return the lines of toString with the given length of a tick instead of the calibrated one, e.g. 1 to
+     * print the latencies in ticks.
+     */
+    static std::string toString(double tickNanoseconds);
+
+private:
+    struct Block {
+        Block();
+
+        std::atomic<std::uint64_t> buckets[TYPES][BUCKETS];
+        std::atomic<std::uint64_t> maxima[TYPES];
+        Block *next;
+    };
+
+    static Block &localBlock();
+
+    static double nanosecondsPerTick();
+
+    static std::atomic<bool> enabled;
+    //the blocks of all the threads, a thread pushes its block once
+    static std::atomic<Block *> blocks;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * A bump allocator: objects are placed one after the other in large blocks, and all the blocks are freed
+ * at once by release(). Objects are never freed one by one - whoever creates an object in the arena destroys it
+ * (runs its destructor) before the arena is released.
+ * The blocks start at firstBlockSize bytes and double in size up to MAX_BLOCK_SIZE.
+ */
+class Arena {
+public:
+    static const std::size_t MAX_BLOCK_SIZE = 1 << 20;
+
+    Arena(std::size_t firstBlockSize = 4096);
+
+    Arena(const Arena &other) = delete;
+
+    Arena &operator=(const Arena &other) = delete;
+
+    Arena(Arena &&other);
+
+    Arena &operator=(Arena &&other);
+
+    ~Arena();
+
+    /**
+     * @return uninitialized memory of the given size and alignment, valid until release().
+     */
+    void *allocate(std::size_t size, std::size_t alignment);
+
+    /**
+     * Constructs an object in the arena.
+     */
+    template<typename T, typename... Args>
+    T *create(Args &&... args) {
+        return new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * Runs the destructor of an object created in the arena, its memory is only reused after release().
+     */
+    template<typename T>
+    static void destroy(T *object) {
+        if (object) {
+            object->~T();
+        }
+    }
+
+    /**
+     * Frees all the blocks. The objects in them must have been destroyed.
+     */
+    void release();
+
+    /**
+     * @return the amount of bytes in the blocks of the arena.
+     */
+    std::size_t getCapacity() const;
+
+private:
+    void addBlock(std::size_t minimalSize);
+
+    std::size_t firstBlockSize;
+    std::size_t nextBlockSize;
+    std::vector<char *> blocks;
+    char *current;
+    char *end;
+    std::size_t capacity;
+};
+
+#endif
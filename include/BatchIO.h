@@ -0,0 +1,62 @@
+#ifndef BATCH_IO_H_
+#define BATCH_IO_H_
+
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/**
+ * An output buffer that writes to a file descriptor in large blocks.
+ * Flush requests (std::endl, std::flush, a tied input stream) are ignored - the buffer is only written when
+ * it is full or when the writer is destroyed, so output costs a syscall per block instead of per line.
+ */
+class BufferedWriter : public std::streambuf {
+public:
+    BufferedWriter(int fd, std::size_t capacity = 1 << 20);
+
+    BufferedWriter(const BufferedWriter &other) = delete;
+
+    BufferedWriter &operator=(const BufferedWriter &other) = delete;
+
+    virtual ~BufferedWriter();
+
+    /**
+     * Writes everything that is buffered to the file descriptor.
+     * @return false if the write failed.
+     */
+    bool flushAll();
+
+protected:
+    virtual int_type overflow(int_type ch);
+
+    virtual std::streamsize xsputn(const char *s, std::streamsize count);
+
+    virtual int sync();
+
+private:
+    int fd;
+    std::vector<char> buffer;
+};
+
+/**
+ * An input buffer over the whole content of a file, which is read with a single read at construction.
+ */
+class ScriptReader : public std::streambuf {
+public:
+    ScriptReader(const std::string &path);
+
+    ScriptReader(const ScriptReader &other) = delete;
+
+    ScriptReader &operator=(const ScriptReader &other) = delete;
+
+    /**
+     * @return false if the file could not be read.
+     */
+    bool isOpen() const;
+
+private:
+    std::vector<char> content;
+    bool open;
+};
+
+#endif
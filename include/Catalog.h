@@ -0,0 +1,269 @@
+#ifndef CATALOG_H_
+#define CATALOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <mutex>
+#include "CatalogLoader.h"
+#include "TagDictionary.h"
+#include "CatalogIndex.h"
+#include "ContentColumns.h"
+#include "Arena.h"
+
+class Watchable;
+
+class Movie;
+
+class Episode;
+
+/**
+ * Describes a tv series once - its name, episode length, tags and the size of every season - instead of
+ * holding an Episode object per episode. The episodes occupy the consecutive ids [firstId, lastId] and are
+ * only created (and kept, in an arena of the series) once they are asked for.
+ */
+class Series {
+public:
+    Series(long firstId, const std::string &name, int episodeLength, const std::vector<int> &seasons,
+           const std::vector<TagId> &tags);
+
+    //Copies the descriptor only, the episodes are created again on demand.
+    Series(const Series &other);
+
+    Series &operator=(const Series &other);
+
+    ~Series();
+
+    long getFirstId() const;
+
+    long getLastId() const;
+
+    bool contains(long id) const;
+
+    std::string const &getName() const;
+
+    int getEpisodeLength() const;
+
+    std::vector<TagId> const &getTags() const;
+
+    /**
+     * @return the amount of episodes in every season.
+     */
+    std::vector<int> getSeasons() const;
+
+    bool checkInTags(TagId tag) const;
+
+    /**
+     * Replaces every tag id with newIds[id], see Watchable::remapTags.
+     */
+    void remapTags(const std::vector<TagId> &newIds);
+
+    /**
+     * @param id the id of an episode of this series.
+     * @return the episode with the given id, created on the first call. An episode that was already created is
+     * found without locking.
+     */
+    Episode *getEpisode(long id) const;
+
+    /**
+     * Creates the string representation of an episode without creating the episode itself.
+     * @param id the id of an episode of this series.
+     */
+    std::string episodeToString(long id) const;
+
+private:
+    /**
+     * Finds the season and the number in the season of the episode with the given id.
+     */
+    void locate(long id, int &season, int &episode) const;
+
+    /**
+     * @return the slots of the episodes, created with the first episode: slot i holds the episode firstId + i
+     * once it was created. Called with episodesLock held.
+     */
+    std::atomic<Episode *> *episodeSlots() const;
+
+    void clearEpisodes();
+
+    long firstId;
+    std::string name;
+    int episodeLength;
+    //seasonEnds[i] is the amount of episodes in seasons 1..i+1
+    std::vector<long> seasonEnds;
+    std::vector<TagId> tags;
+    std::uint64_t tagMask;
+    //the slot of every episode, see episodeSlots
+    mutable std::atomic<std::atomic<Episode *> *> episodes;
+    mutable Arena episodeArena;
+    //the episodes are created on demand by sessions that share the catalog, one at a time
+    mutable std::mutex episodesLock;
+};
+
+/**
+ * The content of a session. Movies get the ids 1..N in the order they are added, the episodes of the series
+ * get the ids that follow them. Tags are interned into a TagDictionary whose ids follow the lexicographic
+ * order of the tags once the catalog is finished, and the indexes used by the recommendations are built then.
+ */
+class Catalog : public CatalogSink {
+public:
+    //catalogs with fewer ids are scanned, an index does not pay for itself on them
+    static const long MIN_INDEXED_SIZE = 4096;
+
+    Catalog();
+
+    Catalog(const Catalog &other);
+
+    Catalog &operator=(const Catalog &other);
+
+    Catalog(Catalog &&other);
+
+    Catalog &operator=(Catalog &&other);
+
+    virtual ~Catalog();
+
+    /**
+     * Adds a movie with the next id. All the movies must be added before the first series.
+     */
+    virtual void addMovie(const std::string &name, int length, const std::vector<std::string> &tags);
+
+    /**
+     * Adds a series whose episodes get the next ids.
+     */
+    virtual void addSeries(const std::string &name, int episodeLength, const std::vector<int> &seasons,
+                           const std::vector<std::string> &tags);
+
+    /**
+     * Sorts the tag dictionary, moves the content to the sorted tag ids and builds the columns and the indexes.
+     */
+    virtual void finish();
+
+    /**
+     * Interns a tag, so content can be added with tag ids instead of strings.
+     * @return the id of the tag.
+     */
+    TagId addTag(const std::string &tag);
+
+    /**
+     * Adds a movie whose tags were interned by addTag.
+     */
+    void addMovie(const std::string &name, int length, const std::vector<TagId> &tags);
+
+    /**
+     * Adds a series whose tags were interned by addTag.
+     */
+    void addSeries(const std::string &name, int episodeLength, const std::vector<int> &seasons,
+                   const std::vector<TagId> &tags);
+
+    /**
+     * Finishes a catalog whose tags were added in lexicographic order with columns and indexes that were built
+     * before, instead of sorting the tags and building them, see CatalogSnapshot.
+     * @param image the memory the columns and the indexes borrow their arrays from, kept alive by the catalog
+     * and its copies.
+     */
+    void finish(ContentColumns &&columns, LengthIndex &&lengthIndex, TagIndex &&tagIndex,
+                std::shared_ptr<const void> image);
+
+    /**
+     * @return the amount of ids in the catalog, the ids are 1..size().
+     */
+    long size() const;
+
+    /**
+     * @return the content with the given id, or nullptr if no such content exists.
+     */
+    Watchable *getWatchable(long id) const;
+
+    std::vector<Movie *> const &getMovies() const;
+
+    std::vector<Series *> const &getSeries() const;
+
+    TagDictionary const &getTagDictionary() const;
+
+    LengthIndex const &getLengthIndex() const;
+
+    TagIndex const &getTagIndex() const;
+
+    ContentColumns const &getColumns() const;
+
+    /**
+     * @return true if the length and tag indexes were built, see MIN_INDEXED_SIZE.
+     */
+    bool isIndexed() const;
+
+    /**
+     * @return a number that changes whenever the content changes. Versions are unique among all the catalogs,
+     * so a result computed from a catalog stays valid while its version is the same, see User::getRecommendation.
+     */
+    std::uint64_t getVersion() const;
+
+    /**
+     * Finds the content closest in length to average that is not in watched, the lowest id among equally close
+     * content. Uses the length index, or scans the columns when the catalog is not indexed.
+     * @return the id of the content, or -1 if all the content was watched.
+     */
+    long findClosestLength(int average, const WatchedSet &watched) const;
+
+    /**
+     * Finds the lowest id with the tag that is not in watched, through the tag index or a scan of the columns.
+     * @return the id, or -1 if there is none.
+     */
+    long findFirstWithTag(TagId tag, const WatchedSet &watched) const;
+
+    /**
+     * The k contents closest in length to average that are not in watched, by distance and then by id,
+     * so the first one is the id findClosestLength returns.
+     * @return the ids, fewer than k if there is not enough unwatched content.
+     */
+    std::vector<long> findClosestLengths(int average, const WatchedSet &watched, std::size_t k) const;
+
+    /**
+     * Appends the ids with the tag that are not in watched and not already in output to output, lowest first,
+     * until output has k ids. The first id appended to an empty output is the one findFirstWithTag returns.
+     */
+    void collectWithTag(TagId tag, const WatchedSet &watched, std::size_t k, std::vector<long> &output) const;
+
+    /**
+     * Creates the content list, one line per id, in the format: "<id>. <title> <length> minutes [tag1,...,tagN]".
+     */
+    std::string toString() const;
+
+    /**
+     * Creates the content lines of the given ids (for example a watch history), in the format of toString.
+     * Episodes are described by their series, without being created.
+     */
+    std::string toString(const std::vector<long> &ids) const;
+
+private:
+    void clear();
+
+    void copy(const Catalog &other);
+
+    void move(Catalog &&other);
+
+    std::vector<TagId> intern(const std::vector<std::string> &tags);
+
+    /**
+     * @return the series that holds the episode with the given id, the id must belong to an episode.
+     */
+    Series *findSeries(long id) const;
+
+    static void appendLine(std::string &output, long id, const std::string &title, int length,
+                           const std::string &tags);
+
+    Arena arena;
+    std::vector<Movie *> movies;
+    std::vector<Series *> series;
+    TagDictionary tagDictionary;
+    LengthIndex lengthIndex;
+    TagIndex tagIndex;
+    ContentColumns columns;
+    //the memory that columns, lengthIndex and tagIndex borrow from, if they do
+    std::shared_ptr<const void> image;
+    bool indexed;
+    long nextId;
+    std::uint64_t version;
+};
+
+#endif
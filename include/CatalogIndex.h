@@ -0,0 +1,124 @@
+#ifndef CATALOG_INDEX_H_
+#define CATALOG_INDEX_H_
+
+#include <vector>
+#include <cstdint>
+#include "WatchedSet.h"
+#include "TagDictionary.h"
+#include "MappedArray.h"
+
+class Movie;
+
+class Series;
+
+/**
+ * A range of consecutive content ids [first, last]. A movie is a range of one id, a series is the range
+ * of its episodes.
+ */
+struct IdRange {
+    long first;
+    long last;
+};
+
+/**
+ * The content ranges of a catalog ordered by length, so the content closest in length to a value
+ * is found by starting at that value and expanding outwards instead of scanning the whole catalog.
+ */
+class LengthIndex {
+public:
+    struct Run {
+        int length;
+        IdRange ids;
+    };
+
+    LengthIndex();
+
+    void build(const std::vector<Movie *> &movies, const std::vector<Series *> &series);
+
+    /**
+     * Uses runs that were built before, for example ones borrowed from a CatalogSnapshot.
+     * @param runs ordered by length, then by the first id.
+     */
+    void assign(MappedArray<Run> &&runs);
+
+    MappedArray<Run> const &getRuns() const;
+
+    /**
+     * Finds the content whose length is the closest to average and is not in watched.
+     * Among content at the same distance the lowest id is returned.
+     * @return the id of the content, or -1 if all the content was watched.
+     */
+    long findClosest(int average, const WatchedSet &watched) const;
+
+    /**
+     * Finds the k contents closest in length to average that are not in watched, in the order of findClosest:
+     * by distance, then by id. Only the length groups up to the k-th content are visited.
+     * @return the ids, at most k of them.
+     */
+    std::vector<long> findClosest(int average, const WatchedSet &watched, std::size_t k) const;
+
+private:
+    /**
+     * Finds the lowest unwatched id in the runs [begin, end) that all have the same length.
+     * @return the id, or -1 if there is none.
+     */
+    long firstUnwatched(std::size_t begin, std::size_t end, const WatchedSet &watched) const;
+
+    /**
+     * Appends the lowest unwatched ids in the runs [begin, end) of a group to output, at most count of them.
+     */
+    void collectUnwatched(std::size_t begin, std::size_t end, const WatchedSet &watched, std::size_t count,
+                          std::vector<long> &output) const;
+
+    //ordered by length, then by the first id
+    MappedArray<Run> runs;
+};
+
+/**
+ * For every tag, the ordered ranges of content ids that have it (a posting list), so a genre recommendation
+ * only walks the content with the tag instead of the whole catalog.
+ * The posting lists are stored one after the other in a single array of ranges.
+ */
+class TagIndex {
+public:
+    TagIndex();
+
+    void build(const std::vector<Movie *> &movies, const std::vector<Series *> &series, std::size_t tagsCount);
+
+    /**
+     * Uses posting lists that were built before, for example ones borrowed from a CatalogSnapshot.
+     * @param ranges the posting lists of all the tags, one after the other.
+     * @param starts the posting list of tag t is ranges[starts[t], starts[t + 1]), one more than the tags.
+     */
+    void assign(MappedArray<IdRange> &&ranges, MappedArray<std::uint32_t> &&starts);
+
+    /**
+     * @return the lowest id of content with the tag that is not in watched, or -1 if there is none.
+     */
+    long findFirst(TagId tag, const WatchedSet &watched) const;
+
+    /**
+     * Appends the ids with the tag that are not in watched and not already in output to output, lowest first,
+     * until output has k ids.
+     */
+    void collect(TagId tag, const WatchedSet &watched, std::size_t k, std::vector<long> &output) const;
+
+    MappedArray<IdRange> const &getRanges() const;
+
+    MappedArray<std::uint32_t> const &getStarts() const;
+
+private:
+    static void add(std::vector<IdRange> &posting, long first, long last);
+
+    /**
+     * The posting list of the tag is [postingBegin(tag), postingEnd(tag)), empty for an unknown tag.
+     */
+    const IdRange *postingBegin(TagId tag) const;
+
+    const IdRange *postingEnd(TagId tag) const;
+
+    MappedArray<IdRange> ranges;
+    MappedArray<std::uint32_t> starts;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef CATALOG_LOADER_H_
+#define CATALOG_LOADER_H_
+
+#include <string>
+#include <vector>
+#include "json.hpp"
+
+/**
+ * Receives the entries of a catalog in id order - all the movies first, then all the tv series.
+ */
+class CatalogSink {
+public:
+    virtual ~CatalogSink();
+
+    virtual void addMovie(const std::string &name, int length, const std::vector<std::string> &tags) = 0;
+
+    virtual void addSeries(const std::string &name, int episodeLength, const std::vector<int> &seasons,
+                           const std::vector<std::string> &tags) = 0;
+
+    /**
+     * Called after the last entry was added.
+     */
+    virtual void finish();
+};
+
+/**
+ * SAX consumer for the config file schema ("movies" and "tv_series" arrays).
+ * Movies are passed to the sink as soon as their object is closed, so the file is never held as a DOM.
+ * Series are only kept as small descriptors (their episodes are not expanded) until the end of the file,
+ * so that their ids always follow the ids of the movies regardless of the order of the two arrays.
+ */
+class CatalogSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+public:
+    CatalogSaxHandler(CatalogSink &sink);
+
+    /**
+     * Passes the buffered series to the sink and finishes it. Called once the whole file was parsed.
+     */
+    void finish();
+
+    virtual bool null();
+
+    virtual bool boolean(bool val);
+
+    virtual bool number_integer(number_integer_t val);
+
+    virtual bool number_unsigned(number_unsigned_t val);
+
+    virtual bool number_float(number_float_t val, const string_t &s);
+
+    virtual bool string(string_t &val);
+
+    virtual bool start_object(std::size_t elements);
+
+    virtual bool key(string_t &val);
+
+    virtual bool end_object();
+
+    virtual bool start_array(std::size_t elements);
+
+    virtual bool end_array();
+
+    virtual bool parse_error(std::size_t position, const std::string &last_token,
+                             const nlohmann::detail::exception &ex);
+
+private:
+    enum Section {
+        NONE, MOVIES, SERIES
+    };
+
+    struct Entry {
+        Entry();
+
+        std::string name;
+        int length;
+        std::vector<int> seasons;
+        std::vector<std::string> tags;
+    };
+
+    void number(long val);
+
+    CatalogSink &sink;
+    int depth;
+    Section section;
+    std::string field;
+    Entry entry;
+    std::vector<Entry> series;
+};
+
+class CatalogLoader {
+public:
+    /**
+     * Streams the json config file at the given path into the sink.
+     * @throws std::runtime_error if the file could not be parsed.
+     */
+    static void loadJson(const std::string &configFilePath, CatalogSink &sink);
+};
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef CATALOG_SNAPSHOT_H_
+#define CATALOG_SNAPSHOT_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Catalog.h"
+
+/**
+ * A compact binary image of a finished catalog, memory mapped and read in place.
+ *
+ * Layout (native byte order, the sections of 8 byte values first so that every section is aligned):
+ * Header | uint64 tagMasks[idCount] | LengthIndex::Run runs[runCount] | IdRange ranges[rangeCount] |
+ * int32 lengths[idCount] | MovieRecord[movieCount] | SeriesRecord[seriesCount] | int32 seasons[seasonCount] |
+ * uint32 tagRefs[tagRefCount] | uint32 starts[startCount] | StringRef strings[stringCount] | char bytes[stringBytes]
+ *
+ * The tag masks and the lengths are the ContentColumns of the catalog, the runs are its LengthIndex and the ranges
+ * and the starts its TagIndex. A loaded catalog borrows them from the mapping, which it keeps alive, instead of
+ * building them. The first tagCount strings are the tags in lexicographic order, so the tag refs are tag ids;
+ * the other strings are the names of the content, which are copied into the movies and series.
+ * The header records the size and modification time of the json file it was built from, so a snapshot
+ * is only used while it is up to date.
+ */
+class CatalogSnapshot {
+public:
+    static const std::uint32_t VERSION = 2;
+
+    /**
+     * @return the path of the snapshot that belongs to the given config file.
+     */
+    static std::string pathFor(const std::string &configFilePath);
+
+    /**
+     * Loads the json config file into a catalog and writes the catalog as a snapshot.
+     * @return true if the snapshot was written.
+     * @throws std::runtime_error if the config file could not be parsed.
+     */
+    static bool write(const std::string &configFilePath, const std::string &snapshotPath);
+
+    /**
+     * Maps the snapshot into an empty catalog and finishes it. The catalog is left untouched if the snapshot is
+     * missing, corrupted, of another version or older than the config file.
+     * @return true if the catalog was loaded from the snapshot.
+     */
+    static bool load(const std::string &snapshotPath, const std::string &configFilePath, Catalog &catalog);
+
+private:
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t headerSize;
+        std::uint64_t sourceSize;
+        std::int64_t sourceMtime;
+        std::uint64_t payloadSize;
+        std::uint64_t checksum;
+        std::uint64_t idCount;
+        std::uint32_t movieCount;
+        std::uint32_t seriesCount;
+        std::uint32_t seasonCount;
+        std::uint32_t tagRefCount;
+        std::uint32_t tagCount;
+        std::uint32_t runCount;
+        std::uint32_t rangeCount;
+        std::uint32_t startCount;
+        std::uint32_t stringCount;
+        std::uint32_t stringBytes;
+    };
+
+    struct MovieRecord {
+        std::uint32_t name;
+        std::int32_t length;
+        std::uint32_t firstTag;
+        std::uint32_t tagCount;
+    };
+
+    struct SeriesRecord {
+        std::uint32_t name;
+        std::int32_t episodeLength;
+        std::uint32_t firstSeason;
+        std::uint32_t seasonCount;
+        std::uint32_t firstTag;
+        std::uint32_t tagCount;
+    };
+
+    struct StringRef {
+        std::uint32_t offset;
+        std::uint32_t length;
+    };
+
+    /**
+     * Pointers to the sections of a mapped payload.
+     */
+    struct Sections {
+        Sections(const Header &header, const char *payload);
+
+        const std::uint64_t *tagMasks;
+        const LengthIndex::Run *runs;
+        const IdRange *ranges;
+        const std::int32_t *lengths;
+        const MovieRecord *movies;
+        const SeriesRecord *series;
+        const std::int32_t *seasons;
+        const std::uint32_t *tagRefs;
+        const std::uint32_t *starts;
+        const StringRef *strings;
+        const char *bytes;
+    };
+
+    /**
+     * Reads the size and modification time (in nanoseconds) of a file.
+     * @return false if the file does not exist.
+     */
+    static bool fileStamp(const std::string &path, std::uint64_t &size, std::int64_t &mtime);
+
+    static std::uint64_t checksum(const char *data, std::size_t size);
+
+    static std::uint64_t payloadSize(const Header &header);
+
+    /**
+     * Checks every reference of the sections before the catalog follows it.
+     */
+    static bool validate(const Header &header, const Sections &sections);
+
+    static void fill(const Header &header, const Sections &sections, std::shared_ptr<const void> image,
+                     Catalog &catalog);
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef COMMAND_TABLE_H_
+#define COMMAND_TABLE_H_
+
+#include <cstddef>
+#include <string>
+
+class Session;
+
+/**
+ * Maps command names to their handlers with an open addressed table of SLOTS slots.
+ * A name is placed at slotOf(name) or, if that slot is taken, at the next free slot after it. slotOf is a perfect
+ * hash over the built in commands of the Session (checked at compile time), so they are found with a single
+ * comparison; commands added later may probe a few slots.
+ */
+class CommandTable {
+public:
+    typedef void (*Handler)(Session &sess);
+
+    static const std::size_t SLOTS = 32;
+
+    /**
+     * @param name a name of at least one character.
+     */
+    static constexpr std::size_t slotOf(const char *name, std::size_t length) {
+        return (static_cast<std::size_t>(name[0]) + 2 * static_cast<std::size_t>(name[1]) + 2 * length) % SLOTS;
+    }
+
+    static constexpr std::size_t lengthOf(const char *name) {
+        return *name == '\0' ? 0 : 1 + lengthOf(name + 1);
+    }
+
+    CommandTable();
+
+    /**
+     * @return false if the name is empty or already in the table, or if the table is full.
+     */
+    bool add(const std::string &name, Handler handler);
+
+    /**
+     * @return the handler of the name, or nullptr if there is none.
+     */
+    Handler find(const std::string &name) const;
+
+private:
+    struct Entry {
+        Entry() : name(), handler(nullptr) {}
+
+        std::string name;
+        Handler handler;
+    };
+
+    Entry entries[SLOTS];
+};
+
+#endif
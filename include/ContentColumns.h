@@ -0,0 +1,82 @@
+#ifndef CONTENT_COLUMNS_H_
+#define CONTENT_COLUMNS_H_
+
+#include <cstdint>
+#include <vector>
+#include "WatchedSet.h"
+#include "TagDictionary.h"
+#include "MappedArray.h"
+
+class Movie;
+
+class Series;
+
+/**
+ * A columnar view of a catalog: the length and tag mask of every id in contiguous arrays.
+ * The ids are positional - row i describes the id i + 1 - so a full scan reads the columns in order
+ * instead of following a pointer to a Watchable (or creating an episode) per id.
+ * The columns are either built from the content or borrowed from a memory mapped CatalogSnapshot.
+ */
+class ContentColumns {
+public:
+    ContentColumns();
+
+    void build(const std::vector<Movie *> &movies, const std::vector<Series *> &series);
+
+    /**
+     * Uses columns that were built before, for example ones borrowed from a CatalogSnapshot.
+     * @param lengths the length of every row.
+     * @param tagMasks the tag mask of every row, as many as lengths.
+     */
+    void assign(MappedArray<int> &&lengths, MappedArray<std::uint64_t> &&tagMasks);
+
+    /**
+     * @return the amount of rows, which is the amount of ids.
+     */
+    std::size_t size() const;
+
+    MappedArray<int> const &getLengths() const;
+
+    /**
+     * The masks hold the tags whose id is lower than TagDictionary::MASK_BITS, see TagDictionary::toMask.
+     */
+    MappedArray<std::uint64_t> const &getTagMasks() const;
+
+    /**
+     * Scans the lengths for the content closest in length to average that is not in watched.
+     * Among content at the same distance the lowest id is returned.
+     * A watched bitmap is applied by the vector kernel of LengthKernel.
+     * @return the id of the content, or -1 if all the content was watched.
+     */
+    long findClosestLength(int average, const WatchedSet &watched) const;
+
+    /**
+     * Scans the tag masks for the lowest id with the tag that is not in watched.
+     * @param tag a tag lower than TagDictionary::MASK_BITS.
+     * @return the id, or -1 if there is none.
+     */
+    long findFirstWithTag(TagId tag, const WatchedSet &watched) const;
+
+    /**
+     * Scans the lengths once for the k contents closest in length to average that are not in watched,
+     * keeping the best k in a bounded heap.
+     * @return their ids by distance, the lowest id first among equal distances, so the first one is the id
+     * findClosestLength returns.
+     */
+    std::vector<long> findClosestLengths(int average, const WatchedSet &watched, std::size_t k) const;
+
+    /**
+     * Appends the ids with the tag that are not in watched and not already in output to output, lowest first,
+     * until output has k ids.
+     * @param tag a tag lower than TagDictionary::MASK_BITS.
+     */
+    void collectWithTag(TagId tag, const WatchedSet &watched, std::size_t k, std::vector<long> &output) const;
+
+private:
+    MappedArray<int> lengths;
+    MappedArray<std::uint64_t> tagMasks;
+    //all the lengths are in the range of LengthKernel
+    bool kernelLengths;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef COPY_ON_WRITE_H_
+#define COPY_ON_WRITE_H_
+
+#include <memory>
+
+/**
+ * A value that copies share until one of them is changed. Copying is O(1), the value itself is only copied
+ * by write() when it is shared, so the copy that changes is the one that pays for it.
+ * Copies that share a value may read it concurrently, but a copy must not be written (or copied) while any
+ * other thread uses a copy that shares its value: write() decides whether to copy by the count of sharers.
+ */
+template<typename T>
+class CopyOnWrite {
+public:
+    CopyOnWrite() : value(std::make_shared<T>()) {}
+
+    const T &operator*() const {
+        return *value;
+    }
+
+    const T *operator->() const {
+        return value.get();
+    }
+
+    /**
+     * @return the value for changing, copied first if another copy shares it.
+     */
+    T &write() {
+        if (value.use_count() > 1) {
+            value = std::make_shared<T>(*value);
+        }
+        return *value;
+    }
+
+    /**
+     * Stops sharing and starts over from an empty value.
+     */
+    void reset() {
+        value = std::make_shared<T>();
+    }
+
+private:
+    std::shared_ptr<T> value;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef LENGTH_KERNEL_H_
+#define LENGTH_KERNEL_H_
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Finds the length closest to a value in a length column, skipping the rows whose id is set in a bitmap
+ * of watched ids (row i is the id i + 1, see ContentColumns).
+ * The distances are computed 8 (AVX2) or 4 (SSE2) rows at a time, the instruction set is chosen at runtime
+ * and a scalar loop is used where neither is available. Every level returns exactly what the scalar loop does:
+ * the lowest id among the unwatched rows at the smallest distance.
+ */
+class LengthKernel {
+public:
+    enum Level {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    //the kernels compute distances in 32 bits, lengths and averages must be in [0, MAX_LENGTH]
+    static const int MAX_LENGTH = 1 << 30;
+
+    /**
+     * @return the best level the cpu supports.
+     */
+    static Level detect();
+
+    static const char *levelName(Level level);
+
+    /**
+     * @param lengths the length column, every length in [0, MAX_LENGTH].
+     * @param count the amount of rows in the column.
+     * @param average a value in [0, MAX_LENGTH].
+     * @param watchedBits bit id % 64 of word id / 64 is set for every watched id, see WatchedSet::getBits.
+     * @param level the instructions to use, at most the level returned by detect().
+     * @return the id of the closest unwatched row, or -1 if every row is watched.
+     */
+    static long findClosest(const int *lengths, std::size_t count, int average,
+                            const std::vector<std::uint64_t> &watchedBits, Level level = detect());
+};
+
+#endif
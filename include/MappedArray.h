@@ -0,0 +1,89 @@
+#ifndef MAPPED_ARRAY_H_
+#define MAPPED_ARRAY_H_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * A read-only array that either owns its elements or borrows them from memory owned elsewhere, such as a
+ * memory mapped CatalogSnapshot. Copies of a borrowed array point to the same elements, so the owner of that
+ * memory must keep it alive as long as any copy is used.
+ */
+template<typename T>
+class MappedArray {
+public:
+    MappedArray() : owned(), first(nullptr), count(0) {}
+
+    /**
+     * Owns the given elements.
+     */
+    explicit MappedArray(std::vector<T> &&elements)
+            : owned(std::move(elements)), first(owned.data()), count(owned.size()) {}
+
+    /**
+     * Borrows the count elements that start at elements.
+     */
+    MappedArray(const T *elements, std::size_t count) : owned(), first(elements), count(count) {}
+
+    MappedArray(const MappedArray &other)
+            : owned(other.owned), first(other.owned.empty() ? other.first : owned.data()), count(other.count) {}
+
+    MappedArray &operator=(const MappedArray &other) {
+        if (this != &other) {
+            MappedArray copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    //swapping vectors keeps their buffers, so an owned array still points into its own elements
+    MappedArray(MappedArray &&other) : owned(), first(nullptr), count(0) {
+        swap(other);
+    }
+
+    MappedArray &operator=(MappedArray &&other) {
+        if (this != &other) {
+            MappedArray moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    const T *data() const {
+        return first;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    const T &operator[](std::size_t index) const {
+        return first[index];
+    }
+
+    const T *begin() const {
+        return first;
+    }
+
+    const T *end() const {
+        return first + count;
+    }
+
+private:
+    void swap(MappedArray &other) {
+        owned.swap(other.owned);
+        std::swap(first, other.first);
+        std::swap(count, other.count);
+    }
+
+    std::vector<T> owned;
+    const T *first;
+    std::size_t count;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef SERVER_H_
+#define SERVER_H_
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+class Catalog;
+
+class Session;
+
+/**
+ * Serves many sessions from one process over a unix domain socket. The catalog is loaded once and shared by
+ * the sessions, every connection gets its own session that speaks the same command language as the terminal,
+ * one command (or one answer to a recommendation) per line.
+ * The server is a single threaded epoll loop, a session only runs while a complete line of its connection
+ * is handled, so a connection that waits for input costs no more than its session and buffers.
+ */
+class Server {
+public:
+    Server(std::shared_ptr<const Catalog> content, const std::string &socketPath);
+
+    Server(const Server &other) = delete;
+
+    Server &operator=(const Server &other) = delete;
+
+    ~Server();
+
+    /**
+     * Bounds the actions log of every session to the given amount of records, see ActionLog.
+     */
+    void setLogCapacity(std::size_t capacity);
+
+    /**
+     * Accepts and serves connections until the process is interrupted (SIGINT or SIGTERM).
+     * @return false if the socket could not be set up.
+     */
+    bool run();
+
+    /**
+     * A line based client for the server: sends the standard input to the socket and prints the replies.
+     * @return the exit code of the client.
+     */
+    static int connect(const std::string &socketPath);
+
+private:
+    struct Connection {
+        Connection(int fd, Session *session);
+
+        Connection(const Connection &other) = delete;
+
+        Connection &operator=(const Connection &other) = delete;
+
+        int fd;
+        Session *session;
+        //received bytes that do not form a complete line yet
+        std::string input;
+        //replies that were not written to the socket yet
+        std::string output;
+        //the session ended, the connection closes once the output is written
+        bool closing;
+    };
+
+    bool listenOn();
+
+    void accept();
+
+    void receive(Connection &connection);
+
+    /**
+     * Runs the session of the connection on every complete line it received.
+     */
+    void handleLines(Connection &connection);
+
+    /**
+     * Writes as much of the pending output as the socket takes.
+     * @return false if the connection failed.
+     */
+    bool send(Connection &connection);
+
+    /**
+     * Asks epoll for writability of the connection only while it has pending output.
+     */
+    void watchOutput(Connection &connection);
+
+    void close(Connection &connection);
+
+    std::shared_ptr<const Catalog> content;
+    std::string socketPath;
+    std::size_t logCapacity;
+    int listenFd;
+    //the socket file was bound by this server, so it is removed with it
+    bool ownsSocket;
+    int epollFd;
+    std::unordered_map<int, Connection *> connections;
+    //the input and output of the session that runs, swapped into std::cin and std::cout
+    std::stringbuf lineBuffer;
+    std::stringbuf replyBuffer;
+};
+
+#endif
@@ -6,9 +6,13 @@
 #include <string>
 #include "Action.h"
 #include "User.h"
-#include "json.hpp"
+#include "Catalog.h"
+#include "CommandTable.h"
+#include "ThreadPool.h"
 #include <list>
 #include <climits>
+#include <memory>
+#include <cstdint>
 
 class User;
 
@@ -20,7 +24,12 @@ public:
     //ctor
     Session(const std::string &configFilePath);
 
-    //Copy ctor
+    /**
+     * Creates a session over an already loaded catalog, which is shared with the other sessions created over it.
+     */
+    Session(std::shared_ptr<const Catalog> catalog);
+
+    //Copy ctor, the copy shares the catalog
     Session(const Session &other);
 
     //Copy assignment
@@ -38,6 +47,24 @@ public:
     //Event loop
     void start();
 
+    /**
+     * Starts a session that is driven one input line at a time by step instead of by the event loop.
+     */
+    void begin();
+
+    /**
+     * Runs the command on the current input line, or answers the recommendation of a watch that waits for one.
+     * A watch does not read its answers itself, it waits for the next step instead.
+     * @return false once the session ended.
+     */
+    bool step();
+
+    /**
+     * Loads the content catalog from the snapshot of the config file if it is up to date,
+     * otherwise streams the config file itself, see CatalogLoader and CatalogSnapshot.
+     */
+    static std::shared_ptr<const Catalog> createContent(const std::string &configFilePath);
+
     //userMap methods
     /**
      * Finds a user in the user map.
@@ -51,15 +78,32 @@ public:
     bool deleteUser(std::string &userName);
 
     //actionsLog Methods
-    void addActionToLog(BaseAction *action);
+    /**
+     * Records the finished action in the actions log, and its latency in the ActionStats: the time since its
+     * command was dispatched, or since the last restartActionTimer.
+     */
+    void addActionToLog(const BaseAction &action);
+
+    /**
+     * Times the current action from now on. A binge restarts the timer after every answer it reads, so its
+     * latency is the work on the last answer and not the time the user took to answer.
+     */
+    void restartActionTimer();
+
+    /**
+     * Bounds the actions log to the given amount of records, see ActionLog.
+     * @param spillPath a file to append the evicted records to, or an empty string to drop them.
+     * @return false if the spill file could not be opened.
+     */
+    bool setLogRetention(std::size_t capacity, const std::string &spillPath);
 
     //content methods
     Watchable *getWatchable(const long &id);
 
     //Getters and Setters
-    std::vector<Watchable *> const &getContent() const;
+    Catalog const &getContent() const;
 
-    std::vector<BaseAction *> const &getActionsLog() const;
+    ActionLog const &getActionsLog() const;
 
     std::unordered_map<std::string, User *> const &getUserMap() const;
 
@@ -71,22 +115,52 @@ public:
 
     void setEndSession(bool set);
 
+    /**
+     * An interactive session prompts for every command, a batch session (a script fed to the input) does not.
+     */
+    void setInteractive(bool set);
+
+    /**
+     * Adds a command to the commands of every session, e.g. a command that runs an action and records it
+     * with addActionToLog. Commands are registered before sessions start to read their input.
+     * @return false if a command with that name already exists or the command table is full.
+     */
+    static bool registerCommand(const std::string &name, CommandTable::Handler handler);
+
     //Recommendation methods
     Watchable *GetRecommendationLength(const LengthRecommenderUser &user, int average);
 
-    Watchable *GetRecommendationGenre(const GenreRecommenderUser &user, const std::string &tag);
+    Watchable *GetRecommendationGenre(const GenreRecommenderUser &user, TagId tag);
 
-    static std::string watchableVectorToString(const std::vector<Watchable *> &vec);
+    std::vector<Watchable *> GetRecommendationsLength(const LengthRecommenderUser &user, int average, std::size_t k);
 
-    std::string actionsLogToString();
+    /**
+     * Appends the ids of up to k unwatched contents with the tag that are not already in ids, see
+     * Catalog::collectWithTag.
+     */
+    void GetRecommendationsGenre(const GenreRecommenderUser &user, TagId tag, std::size_t k, std::vector<long> &ids);
+
+    /**
+     * Computes the recommendation of every user in parallel on the threads of pool, see User::getRecommendation.
+     * The catalog is only read and every user is handled by a single thread.
+     * @return the users ordered by name, each with its recommendation or nullptr if it has none.
+     */
+    std::vector<std::pair<User *, Watchable *>> getAllRecommendations(ThreadPool &pool);
 
 private:
 
-    std::vector<Watchable *> content;
-    std::vector<BaseAction *> actionsLog;
+    std::shared_ptr<const Catalog> content;
+    ActionLog actionsLog;
     std::unordered_map<std::string, User *> userMap;
     User *activeUser;
     bool endSession;
+    bool interactive;
+    //true while a step runs
+    bool stepping;
+    //a watch of a stepped session that waits for an answer, logged once it is complete
+    Watch *pendingWatch;
+    //when the timing of the current action started, in ActionStats::now() ticks, see restartActionTimer
+    std::uint64_t actionStart;
 
     //ctor, assignment and destructor methods
     void clear();
@@ -97,12 +171,6 @@ private:
 
 
     //Content creating methods
-    void createContent(const std::string &configFilePath);
-
-    void extractMoviesContent(nlohmann::json &j, long &id);
-
-    void extractTVContent(const nlohmann::basic_json<> &j, long id);
-
     void createDefaultUser();
 
     //event loop methods
@@ -115,6 +183,9 @@ private:
      */
     void actionChooser(const std::string &command);
 
+    //the commands of all the sessions, starting with the built in ones
+    static CommandTable &commands();
+
     void createUser();
 
     void changeActiveUser();
@@ -127,14 +198,42 @@ private:
 
     void printWatchHistory();
 
+    /**
+     * log prints the whole actions log, log <offset> <count> a range of it and log tail <n> its newest n records.
+     */
     void printActionsLog();
 
     void exitSession();
 
-    void watch(long &&recommendId);
+    /**
+     * recommend <k> prints the k best recommendations for the active user.
+     */
+    void recommend();
+
+    /**
+     * recommendall <file> writes the recommendation of every user to the file.
+     */
+    void recommendAll();
+
+    //prints the ActionStats, the command is not an action and is not logged
+    void printStats();
+
+    void watch();
 
     void clearInputBuffer() const;
 
+    /**
+     * Reads the next word of the current input line.
+     * @return false if the line has no more words.
+     */
+    bool readArgument(std::string &argument) const;
+
+    /**
+     * Reads the next word of the current input line as a non negative number.
+     * @return false if the line has no more words or the word is not a number.
+     */
+    bool readCount(std::size_t &count) const;
+
 };
 
 #endif
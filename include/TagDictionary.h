@@ -0,0 +1,64 @@
+#ifndef TAG_DICTIONARY_H_
+#define TAG_DICTIONARY_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+typedef std::uint32_t TagId;
+
+/**
+ * Interns the tags of a catalog, so content holds small integer ids instead of strings.
+ * The string form of a tag is only needed for output.
+ */
+class TagDictionary {
+public:
+    //Tags with an id below this limit are also represented by a bit in a tag mask.
+    static const TagId MASK_BITS = 64;
+
+    TagDictionary();
+
+    /**
+     * @return the id of the tag, a new id is given to a tag that was not seen before.
+     */
+    TagId intern(const std::string &tag);
+
+    /**
+     * Finds the id of a tag without adding it.
+     * @return true if the tag exists in the dictionary.
+     */
+    bool find(const std::string &tag, TagId &id) const;
+
+    std::string const &getTag(TagId id) const;
+
+    std::size_t size() const;
+
+    /**
+     * Gives the tags new ids by the lexicographic order of their strings, so comparing two ids
+     * gives the same result as comparing the two strings.
+     * @return the new id of every old id.
+     */
+    std::vector<TagId> sort();
+
+    /**
+     * Creates a string representation of the tags in the format: [tag1, tag2,...,tagN].
+     */
+    std::string toString(const std::vector<TagId> &tags) const;
+
+    /**
+     * @return a mask with the bit of every tag whose id is below MASK_BITS.
+     */
+    static std::uint64_t toMask(const std::vector<TagId> &tags);
+
+    /**
+     * Checks if a tag is in an ordered tags vector, using the mask when the tag has a bit.
+     */
+    static bool contains(const std::vector<TagId> &tags, std::uint64_t mask, TagId tag);
+
+private:
+    std::vector<std::string> tags;
+    std::unordered_map<std::string, TagId> ids;
+};
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef TAG_POPULARITY_H_
+#define TAG_POPULARITY_H_
+
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include "TagDictionary.h"
+
+/**
+ * Counts how many times every tag was watched and keeps the tags ordered by their count in descending order,
+ * and tags with the same count by lexicographic order (tag ids follow it, see TagDictionary::sort).
+ * Adding to a tag costs O(log n) instead of re-sorting all the tags.
+ */
+class TagPopularity {
+private:
+    struct Order {
+        bool operator()(const std::pair<int, TagId> &p1, const std::pair<int, TagId> &p2) const;
+    };
+
+public:
+    typedef std::set<std::pair<int, TagId>, Order>::const_iterator const_iterator;
+
+    TagPopularity();
+
+    /**
+     * Increases the count of the tag by one, a tag that was not counted yet gets a count of 1.
+     * @return true if the order of the tags changed: the tag is new or passed the tag before it.
+     */
+    bool add(TagId tag);
+
+    /**
+     * @return the count of the tag, 0 if it was never added.
+     */
+    int getCount(TagId tag) const;
+
+    std::size_t size() const;
+
+    /**
+     * Iterates the (count, tag) pairs from the most popular tag to the least popular one.
+     */
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+private:
+    std::unordered_map<TagId, int> counts;
+    std::set<std::pair<int, TagId>, Order> ordered;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads that run a loop over a range of indexes together with the calling thread.
+ * The range is split into chunks that the threads take from a shared counter, so a thread that finishes its
+ * chunks early takes more of them instead of waiting for the others.
+ */
+class ThreadPool {
+public:
+    /**
+     * A task runs on the indexes [begin, end).
+     */
+    typedef std::function<void(std::size_t begin, std::size_t end)> Task;
+
+    /**
+     * @param threads the amount of threads that run a loop, including the calling thread. A pool of 1 thread
+     * runs its loops on the calling thread only.
+     */
+    ThreadPool(std::size_t threads);
+
+    ThreadPool(const ThreadPool &other) = delete;
+
+    ThreadPool &operator=(const ThreadPool &other) = delete;
+
+    /**
+     * Stops the workers once they finish the current loop.
+     */
+    ~ThreadPool();
+
+    std::size_t size() const;
+
+    /**
+     * Runs task on every index in [0, count) and returns once all of them ran. Loops of different callers
+     * run one after the other. If a task throws, the rest of the indexes are skipped and the exception is
+     * rethrown here.
+     */
+    void forEach(std::size_t count, const Task &task);
+
+    /**
+     * @return a pool with a thread for every core, created on first use and shared by the whole program.
+     */
+    static ThreadPool &shared();
+
+private:
+    void work();
+
+    //runs chunks of the current loop until there are no more
+    void runChunks();
+
+    std::vector<std::thread> workers;
+    //held by forEach for the whole loop
+    std::mutex running;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    //the current loop, set under lock before the workers are woken
+    const Task *task;
+    std::size_t count;
+    std::size_t chunk;
+    std::atomic<std::size_t> next;
+    //the workers that did not finish the current loop yet
+    std::size_t busy;
+    std::uint64_t generation;
+    std::exception_ptr failure;
+    bool stopping;
+};
+
+#endif
@@ -2,10 +2,15 @@
 #define USER_H_
 
 #include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <unordered_set>
 #include <unordered_map>
+#include "TagDictionary.h"
+#include "WatchedSet.h"
+#include "TagPopularity.h"
+#include "CopyOnWrite.h"
 
 class Watchable;
 
@@ -33,6 +38,7 @@ public:
 
     /**
     * Creates a clone of this user with a new name.
+    * The clone shares the history and the recommendation state with this user until one of them changes it.
     * @param name the name of the new user.
     * @return the created clone.
     */
@@ -43,25 +49,88 @@ public:
      * @param s a session
      * @return a watchable pointer to be recommended to the active user
      * (based on the algorithm chosen)
+     * The recommendation is kept until the history or the catalog of the session changes it, so asking again
+     * costs O(1).
      */
-    virtual Watchable *getRecommendation(Session &s) = 0;
+    Watchable *getRecommendation(Session &s);
+
+    /**
+     * @param s a session
+     * @param k the amount of recommendations to return
+     * @return up to k watchables to recommend to the user, best first, found in one walk over the candidates.
+     * The first one is the one getRecommendation returns. Kept like getRecommendation, a cached top k also
+     * answers any smaller k.
+     */
+    std::vector<Watchable *> getRecommendations(Session &s, std::size_t k);
 
     std::string getName() const;
 
-    std::vector<Watchable *> const &getHistory() const;
+    /**
+     * @return the ids of the watched content in the session catalog, in the order they were watched.
+     */
+    std::vector<long> const &getHistory() const;
 
     /**
      * @param a pointer to a watchable
-     * @return true if it exists in the user's history
+     * @return true if it exists in the user's history, in O(1)
      */
     bool isInHistory(const Watchable *) const;
 
+    /**
+     * @param id the id of a content in the session catalog.
+     * @return true if the content with this id exists in the user's history
+     */
+    bool isInHistory(long id) const;
+
+    WatchedSet const &getWatched() const;
+
+    /**
+     * Adds the id of the watchable to the history. The watchable itself stays owned by the catalog.
+     * Watching a cached recommendation removes it from the cache, the others stay the best ones.
+     */
     virtual void addToHistory(Watchable *watchable);
 
 protected:
+    //shared with the duplicates of the user until one of them watches something
+    CopyOnWrite<std::vector<long>> history;
+
+    /**
+     * Computes the recommendation of the algorithm, see getRecommendation.
+     */
+    virtual Watchable *findRecommendation(Session &s) = 0;
+
+    /**
+     * Computes the top k recommendations of the algorithm, see getRecommendations.
+     */
+    virtual std::vector<Watchable *> findRecommendations(Session &s, std::size_t k) = 0;
+
+    /**
+     * Drops the cached recommendations, called when the state of the algorithm changes.
+     */
+    void invalidateRecommendations();
 
-    std::vector<Watchable *> history;
 private:
+    /**
+     * The last recommendations computed: the best ones of the k asked for, all of them if there are fewer.
+     * Valid while k > 0 and the catalog is of the same version.
+     */
+    struct RecommendationCache {
+        RecommendationCache();
+
+        std::uint64_t catalogVersion;
+        std::size_t k;
+        std::vector<Watchable *> best;
+    };
+
+    /**
+     * @return true if the cache holds the top k recommendations for the catalog of s.
+     */
+    bool isCached(const Session &s, std::size_t k) const;
+
+    //the ids in history, for membership checks
+    CopyOnWrite<WatchedSet> watched;
+    RecommendationCache cache;
+
     void clear();
 
     void copy(const User &other);
@@ -94,10 +163,13 @@ public:
 
     virtual User *clone(std::string &name);
 
-    virtual Watchable *getRecommendation(Session &s);
-
     virtual void addToHistory(Watchable *watchable);
 
+protected:
+    virtual Watchable *findRecommendation(Session &s);
+
+    virtual std::vector<Watchable *> findRecommendations(Session &s, std::size_t k);
+
 private:
 
     /**
@@ -130,15 +202,18 @@ public:
 
     virtual User *clone(std::string &name);
 
-    virtual Watchable *getRecommendation(Session &s);
-
     /**
      *
      * @param watchable pointer
-     * adds the pointer to the history vector.
+     * adds the id of the watchable to the history vector.
      */
     virtual void addToHistory(Watchable *watchable);
 
+protected:
+    virtual Watchable *findRecommendation(Session &s);
+
+    virtual std::vector<Watchable *> findRecommendations(Session &s, std::size_t k);
+
 private:
 
 
@@ -169,38 +244,30 @@ public:
 
     virtual User *clone(std::string &name);
 
-    virtual Watchable *getRecommendation(Session &s);
-
     virtual void addToHistory(Watchable *watchable);
 
-private:
-    //keeps for each user its most popular tags
-    std::vector<std::pair<int, std::string>> mostPopularTags;
+protected:
+    virtual Watchable *findRecommendation(Session &s);
 
-    /**
-     * Driver function to sort the vector elements by
-    first element of pair in descending order and if two are equal - by lexicographic order of the second
-     */
-    static bool sortInRevLex(const std::pair<int, std::string> &p1, const std::pair<int, std::string> &p2);
+    virtual std::vector<Watchable *> findRecommendations(Session &s, std::size_t k);
 
-    /**
-     * Sorts the mostPopularTags vector in descending order according to the first type,
-     * and then according to the second by lexicographic order.
-     */
-    void sortPopularTags();
+private:
+    //keeps for each user its most popular tags, shared with the duplicates of the user like the history
+    CopyOnWrite<TagPopularity> mostPopularTags;
 
     /**
-    * if the tag exists in the vector we sum the tag counter of the tag in mostPopularTags
-    * if it doesn't exist - create a new pair.
-    * @param tag of a tag to add to the mostPopularVector
+    * Increases the counter of the tag in mostPopularTags, which keeps the tags in their order.
+    * @param tag of a tag to add to the mostPopularTags
+    * @return true if the order of the tags changed.
      */
-    void addTag(const std::string &tag);
+    bool addTag(TagId tag);
 
     /**
      * adds all his tags to the mostPopularTags using addTag
      * @param watchable
+     * @return true if the order of the tags changed.
      */
-    void addTags(Watchable *watchable);
+    bool addTags(Watchable *watchable);
 };
 
 #endif
\ No newline at end of file
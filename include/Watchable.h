@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include "TagDictionary.h"
 
 class Session;
 
@@ -11,7 +12,7 @@ class Session;
 class Watchable {
 public:
     //constructor
-    Watchable(long id, int length, const std::vector<std::string> &tags);
+    Watchable(long id, int length, const std::vector<TagId> &tags);
 
     //copy constructor
     Watchable(const Watchable &watchable);
@@ -33,7 +34,7 @@ public:
 
     long getId() const;
 
-    std::vector<std::string> const &getTags() const;
+    std::vector<TagId> const &getTags() const;
 
     virtual std::string getName() const = 0;
 
@@ -46,25 +47,31 @@ public:
      */
     virtual Watchable *getNextWatchable(Session &) const = 0;
 
-    bool checkInTags(const std::string &tag) const;
+    bool checkInTags(TagId tag) const;
 
     /**
      * Creates and returns a string representation of the tags vector int the format: [tag1, tag2,...,tagN].
+     * @param dictionary the dictionary the tag ids belong to.
      */
-    std::string tagsToString() const;
+    std::string tagsToString(const TagDictionary &dictionary) const;
 
+    /**
+     * Replaces every tag id with newIds[id]. Used by the catalog once it sorted its TagDictionary.
+     */
+    void remapTags(const std::vector<TagId> &newIds);
 
 
 private:
     const long id;
     int length;
-    std::vector<std::string> tags;
+    std::vector<TagId> tags;
+    std::uint64_t tagMask;
 };
 
 
 class Movie : public Watchable {
 public:
-    Movie(long id, const std::string &name, int length, const std::vector<std::string> &tags);
+    Movie(long id, const std::string &name, int length, const std::vector<TagId> &tags);
 
     Movie(Movie &movie);
 
@@ -96,7 +103,7 @@ private:
 class Episode : public Watchable {
 public:
     Episode(long id, const std::string &seriesName, int length, int season, int episode,
-            const std::vector<std::string> &tags);
+            const std::vector<TagId> &tags);
 
     Episode(Episode &other);
 
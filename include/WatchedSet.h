@@ -0,0 +1,60 @@
+#ifndef WATCHED_SET_H_
+#define WATCHED_SET_H_
+
+#include <cstdint>
+#include <vector>
+#include <unordered_set>
+
+/**
+ * The set of content ids a user watched.
+ * Starts as a hash set, which is small for users that watched little, and turns into a bitmap over the ids
+ * once the bitmap would take less memory than the hash set. Both forms answer contains() in O(1)
+ * without allocating.
+ */
+class WatchedSet {
+public:
+    WatchedSet();
+
+    void add(long id);
+
+    bool contains(long id) const;
+
+    /**
+     * @return the lowest id in [first, last] that is not in the set, or -1 if all of them are.
+     * A bitmap skips 64 watched ids at a time.
+     */
+    long firstMissing(long first, long last) const;
+
+    /**
+     * @return the amount of different ids in the set.
+     */
+    std::size_t size() const;
+
+    /**
+     * @return true if the set is held as a bitmap.
+     */
+    bool isDense() const;
+
+    /**
+     * @return the bitmap words (bit id % 64 of word id / 64), empty while the set is not dense.
+     */
+    std::vector<std::uint64_t> const &getBits() const;
+
+    void clear();
+
+private:
+    //approximate memory of a hash set node, in bits
+    static const std::size_t SPARSE_ENTRY_BITS = 32 * 8;
+
+    void addBit(long id);
+
+    void toDense();
+
+    std::unordered_set<long> sparse;
+    std::vector<std::uint64_t> bits;
+    bool dense;
+    std::size_t count;
+    long maxId;
+};
+
+#endif
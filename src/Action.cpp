@@ -2,6 +2,8 @@
 #include "../include/User.h"
 #include "../include/Session.h"
 #include "../include/Watchable.h"
+#include <fstream>
+#include <limits>
 
 //Base Action
 
@@ -83,6 +85,15 @@ BaseAction *CreateUser::clone() {
     return new CreateUser(*this);
 }
 
+ActionRecord CreateUser::toRecord(StringPool &strings) const {
+    return {CREATE_USER, static_cast<std::uint8_t>(getStatus()), strings.intern(userName),
+            strings.intern(algorithmType)};
+}
+
+ActionType CreateUser::getType() const {
+    return CREATE_USER;
+}
+
 //Change Active User
 ChangeActiveUser::ChangeActiveUser(std::string &userName) : userName(userName) {
     std::string errorMsg = "Could not change active user to " + userName;
@@ -108,6 +119,14 @@ BaseAction *ChangeActiveUser::clone() {
     return new ChangeActiveUser(*this);
 }
 
+ActionRecord ChangeActiveUser::toRecord(StringPool &strings) const {
+    return {CHANGE_ACTIVE_USER, static_cast<std::uint8_t>(getStatus()), strings.intern(userName), 0};
+}
+
+ActionType ChangeActiveUser::getType() const {
+    return CHANGE_ACTIVE_USER;
+}
+
 //Duplicate User
 DuplicateUser::DuplicateUser(std::string &oldUserName, std::string &newUserName) : oldUserName(oldUserName),
                                                                                    newUserName(newUserName) {
@@ -140,6 +159,15 @@ BaseAction *DuplicateUser::clone() {
     return new DuplicateUser(*this);
 }
 
+ActionRecord DuplicateUser::toRecord(StringPool &strings) const {
+    return {DUPLICATE_USER, static_cast<std::uint8_t>(getStatus()), strings.intern(oldUserName),
+            strings.intern(newUserName)};
+}
+
+ActionType DuplicateUser::getType() const {
+    return DUPLICATE_USER;
+}
+
 //Delete User
 DeleteUser::DeleteUser(std::string &userName) : userName(userName) {
     std::string errorMsg = "Could not delete user: '" + userName + "'";
@@ -164,6 +192,14 @@ BaseAction *DeleteUser::clone() {
     return new DeleteUser(*this);
 }
 
+ActionRecord DeleteUser::toRecord(StringPool &strings) const {
+    return {DELETE_USER, static_cast<std::uint8_t>(getStatus()), strings.intern(userName), 0};
+}
+
+ActionType DeleteUser::getType() const {
+    return DELETE_USER;
+}
+
 //Print Content List
 PrintContentList::PrintContentList() {
 
@@ -173,7 +209,7 @@ PrintContentList::PrintContentList() {
 
 void PrintContentList::act(Session &sess) {
     //todo: check for memory leaks
-    std::string output = Session::watchableVectorToString(sess.getContent());
+    std::string output = sess.getContent().toString();
     std::cout << output << std::endl;
     complete();
 }
@@ -187,6 +223,14 @@ BaseAction *PrintContentList::clone() {
     return new PrintContentList(*this);
 }
 
+ActionRecord PrintContentList::toRecord(StringPool &) const {
+    return {PRINT_CONTENT_LIST, static_cast<std::uint8_t>(getStatus()), 0, 0};
+}
+
+ActionType PrintContentList::getType() const {
+    return PRINT_CONTENT_LIST;
+}
+
 //Print Watch History
 PrintWatchHistory::PrintWatchHistory() {
     std::string errorMsg = "Could not print watch history";
@@ -194,8 +238,7 @@ PrintWatchHistory::PrintWatchHistory() {
 }
 
 void PrintWatchHistory::act(Session &sess) {
-    std::vector<Watchable *> history = sess.getActiveUser()->getHistory();
-    std::string output = Session::watchableVectorToString(history);
+    std::string output = sess.getContent().toString(sess.getActiveUser()->getHistory());
     std::cout << sess.getActiveUser()->getName() << std::endl;
     std::cout << output << std::endl;
     complete();
@@ -210,15 +253,30 @@ BaseAction *PrintWatchHistory::clone() {
     return new PrintWatchHistory(*this);
 }
 
+ActionRecord PrintWatchHistory::toRecord(StringPool &) const {
+    return {PRINT_WATCH_HISTORY, static_cast<std::uint8_t>(getStatus()), 0, 0};
+}
+
+ActionType PrintWatchHistory::getType() const {
+    return PRINT_WATCH_HISTORY;
+}
+
 //Print Actions Log
-PrintActionsLog::PrintActionsLog() {
+PrintActionsLog::PrintActionsLog() : PrintActionsLog(0, std::numeric_limits<std::size_t>::max()) {}
+
+PrintActionsLog::PrintActionsLog(std::size_t offset, std::size_t count) : offset(offset), count(count) {
     std::string errorMsg = "Could not print actions log";
     setErrorMsg(errorMsg);
 }
 
 void PrintActionsLog::act(Session &sess) {
-    std::string output = sess.actionsLogToString();
-    std::cout << output << std::endl;
+    ActionLog const &log = sess.getActionsLog();
+    if (offset > log.size()) {
+        error(getErrorMsg());
+        return;
+    }
+    log.write(std::cout, offset, count);
+    std::cout << std::endl;
     complete();
 }
 
@@ -231,73 +289,103 @@ BaseAction *PrintActionsLog::clone() {
     return new PrintActionsLog(*this);
 }
 
+ActionRecord PrintActionsLog::toRecord(StringPool &) const {
+    return {PRINT_ACTIONS_LOG, static_cast<std::uint8_t>(getStatus()), 0, 0};
+}
+
+ActionType PrintActionsLog::getType() const {
+    return PRINT_ACTIONS_LOG;
+}
+
 //Watch
-Watch::Watch(long id) : id(id), nextId(-1), keepWatching(false) {
+Watch::Watch(long id) : id(id), steps(0), recommendationId(-1), lastId(id) {
     std::string errorMsg = "Could not stream content with id '" + std::to_string(id) + "'";
     setErrorMsg(errorMsg);
 }
 
+Watch::Watch(long id, int steps) : Watch(id) {
+    this->steps = steps;
+}
+
 void Watch::act(Session &sess) {
+    begin(sess);
+    while (isWaitingForAnswer()) {
+        std::string answer;
+        std::cin >> answer;
+        //the time the user takes to answer is not part of the action
+        sess.restartActionTimer();
+        this->answer(sess, answer);
+    }
+}
+
+void Watch::begin(Session &sess) {
     //try to get a watchable with given id
     Watchable *watchable = sess.getWatchable(id);
     if (!watchable) {
+        steps++;
         error(getErrorMsg());
         return;
     }
-    Watchable *toWatch = watchable->clone();
+    watchNext(sess, watchable);
+}
 
-    //print to screen and add to history
-    std::cout << "Watching " + toWatch->toString() << std::endl;
-    User *activeUser = sess.getActiveUser();
-    activeUser->addToHistory(toWatch);
+bool Watch::isWaitingForAnswer() const {
+    return recommendationId != -1;
+}
 
-    //try to get recommendation and change status to complete
-    newRecommendation(sess, toWatch);
-    if (getStatus() != ERROR) {
+void Watch::answer(Session &sess, const std::string &answer) {
+    Watchable *next = sess.getWatchable(recommendationId);
+    recommendationId = -1;
+    if (answer == "Y" || answer == "y") {
+        watchNext(sess, next);
+    } else if (answer == "N" || answer == "n") {
         complete();
+    } else {
+        std::string newErrorMsg = "Invalid input";
+        error(newErrorMsg);
     }
 }
 
-void Watch::newRecommendation(Session &sess, Watchable *const watched) {
-    Watchable *recommendation = watched->getNextWatchable(sess);
-    if (recommendation) {
-        std::cout << "We recommend watching " + recommendation->toString() + ", continue watching?[Y/N]";
-        std::string answer;
-        std::cin >> answer;
+void Watch::watchNext(Session &sess, Watchable *watchable) {
+    steps++;
+    lastId = watchable->getId();
+    std::string errorMsg = "Could not stream content with id '" + std::to_string(lastId) + "'";
+    setErrorMsg(errorMsg);
 
-        setNextId(recommendation->getId());
-        if (answer == "Y" || answer == "y") {
-            keepWatching = true;
+    //print to screen and add to history
+    std::cout << "Watching " + watchable->toString() << std::endl;
+    sess.getActiveUser()->addToHistory(watchable);
 
-        } else if (answer != "N" && answer != "n") {
-            std::string newErrorMsg = "Invalid input";
-            error(newErrorMsg);
-        }
+    //the recommendation is ready before the user is asked about it
+    Watchable *recommendation = watchable->getNextWatchable(sess);
+    if (recommendation) {
+        recommendationId = recommendation->getId();
+        std::cout << "We recommend watching " + recommendation->toString() + ", continue watching?[Y/N]";
     } else {
         error(getErrorMsg());
     }
-    recommendation = nullptr;
 }
 
 std::string Watch::toString() const {
-    return "Watch " + getStatusMessage();
+    std::string output;
+    //every step before the last one was answered with 'y'
+    for (int step = 1; step < steps; step++) {
+        output.append("Watch completed\n");
+    }
+    return output + "Watch " + getStatusMessage();
 }
 
-//Getters and setters
-long Watch::getNextId() const {
-    return nextId;
+BaseAction *Watch::clone() {
+    return new Watch(*this);
 }
 
-bool Watch::getKeepWatching() const {
-    return keepWatching;
+ActionRecord Watch::toRecord(StringPool &) const {
+    return {WATCH, static_cast<std::uint8_t>(getStatus()), static_cast<std::uint32_t>(steps),
+            static_cast<std::uint64_t>(lastId)};
 }
 
-void Watch::setNextId(long newNextId) {
-    this->nextId = newNextId;
-}
-
-BaseAction *Watch::clone() {
-    return new Watch(*this);
+ActionType Watch::getType() const {
+    return WATCH;
 }
 
 //Exit
@@ -318,4 +406,86 @@ std::string Exit::toString() const {
 
 BaseAction *Exit::clone() {
     return new Exit(*this);
-}
\ No newline at end of file
+}
+
+ActionRecord Exit::toRecord(StringPool &) const {
+    return {EXIT, static_cast<std::uint8_t>(getStatus()), 0, 0};
+}
+
+ActionType Exit::getType() const {
+    return EXIT;
+}
+
+//Recommend
+Recommend::Recommend(std::size_t k) : k(k) {
+    std::string errorMsg = "Could not recommend content";
+    setErrorMsg(errorMsg);
+}
+
+void Recommend::act(Session &sess) {
+    std::vector<long> ids;
+    for (Watchable *watchable : sess.getActiveUser()->getRecommendations(sess, k)) {
+        ids.push_back(watchable->getId());
+    }
+    if (ids.empty()) {
+        error(getErrorMsg());
+        return;
+    }
+    std::cout << sess.getContent().toString(ids) << std::endl;
+    complete();
+}
+
+std::string Recommend::toString() const {
+    std::string output = "Recommend " + std::to_string(k) + " " + getStatusMessage();
+    return output;
+}
+
+BaseAction *Recommend::clone() {
+    return new Recommend(*this);
+}
+
+ActionRecord Recommend::toRecord(StringPool &) const {
+    return {RECOMMEND, static_cast<std::uint8_t>(getStatus()), 0, static_cast<std::uint64_t>(k)};
+}
+
+ActionType Recommend::getType() const {
+    return RECOMMEND;
+}
+
+//Recommend All
+RecommendAll::RecommendAll(const std::string &path) : path(path) {
+    std::string errorMsg = "Could not write recommendations to " + path;
+    setErrorMsg(errorMsg);
+}
+
+void RecommendAll::act(Session &sess) {
+    std::string output;
+    for (auto const &recommendation : sess.getAllRecommendations(ThreadPool::shared())) {
+        output += recommendation.first->getName() + " ";
+        output += recommendation.second ? std::to_string(recommendation.second->getId()) : "-";
+        output += "\n";
+    }
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(output.data(), static_cast<std::streamsize>(output.size())) || !file.flush()) {
+        error(getErrorMsg());
+        return;
+    }
+    complete();
+}
+
+std::string RecommendAll::toString() const {
+    std::string output = "Recommend all to " + path + " " + getStatusMessage();
+    return output;
+}
+
+BaseAction *RecommendAll::clone() {
+    return new RecommendAll(*this);
+}
+
+ActionRecord RecommendAll::toRecord(StringPool &strings) const {
+    return {RECOMMEND_ALL, static_cast<std::uint8_t>(getStatus()), strings.intern(path), 0};
+}
+
+ActionType RecommendAll::getType() const {
+    return RECOMMEND_ALL;
+}
@@ -0,0 +1,243 @@
+#include "../include/ActionLog.h"
+#include "../include/Action.h"
+
+//STRING_POOL
+StringPool::StringPool() : ids(), entries(), freeIds() {}
+
+std::uint32_t StringPool::intern(const std::string &value) {
+    auto found = ids.find(value);
+    if (found != ids.end()) {
+        entries[found->second].references++;
+        return found->second;
+    }
+    std::uint32_t id;
+    if (freeIds.empty()) {
+        id = static_cast<std::uint32_t>(entries.size());
+        entries.push_back({value, 1});
+    } else {
+        id = freeIds.back();
+        freeIds.pop_back();
+        entries[id] = {value, 1};
+    }
+    ids.insert(std::make_pair(value, id));
+    return id;
+}
+
+void StringPool::release(std::uint32_t id) {
+    Entry &entry = entries.at(id);
+    if (--entry.references > 0) {
+        return;
+    }
+    ids.erase(entry.value);
+    //give the memory of the string back, its id may be reused by a short string
+    std::string().swap(entry.value);
+    freeIds.push_back(id);
+}
+
+std::string const &StringPool::get(std::uint32_t id) const {
+    return entries.at(id).value;
+}
+
+std::size_t StringPool::size() const {
+    return entries.size();
+}
+
+//ACTION_LOG
+ActionLog::ActionLog() : strings(), records(), head(0), capacity(UNBOUNDED), spillFile() {}
+
+ActionLog::ActionLog(const ActionLog &other) : strings(), records(), head(0), capacity(UNBOUNDED), spillFile() {
+    copy(other);
+}
+
+ActionLog &ActionLog::operator=(const ActionLog &other) {
+    if (this != &other) {
+        clear();
+        copy(other);
+    }
+    return *this;
+}
+
+ActionLog::ActionLog(ActionLog &&other) : strings(), records(), head(0), capacity(UNBOUNDED), spillFile() {
+    move(std::move(other));
+}
+
+ActionLog &ActionLog::operator=(ActionLog &&other) {
+    if (this != &other) {
+        clear();
+        move(std::move(other));
+    }
+    return *this;
+}
+
+ActionLog::~ActionLog() = default;
+
+void ActionLog::setCapacity(std::size_t newCapacity) {
+    //unroll the ring so the records are ordered from the oldest again
+    std::vector<ActionRecord> ordered;
+    ordered.reserve(records.size());
+    for (std::size_t position = 0; position < records.size(); position++) {
+        ordered.push_back(at(position));
+    }
+    std::size_t evicted = 0;
+    if (newCapacity != UNBOUNDED && ordered.size() > newCapacity) {
+        evicted = ordered.size() - newCapacity;
+        for (std::size_t position = 0; position < evicted; position++) {
+            evict(ordered[position]);
+        }
+    }
+    records.assign(ordered.begin() + evicted, ordered.end());
+    head = 0;
+    capacity = newCapacity;
+}
+
+bool ActionLog::setSpillPath(const std::string &path) {
+    spillFile.reset(new std::ofstream(path, std::ios::app));
+    if (!*spillFile) {
+        spillFile.reset();
+        return false;
+    }
+    return true;
+}
+
+void ActionLog::add(const BaseAction &action) {
+    ActionRecord record = action.toRecord(strings);
+    if (capacity == UNBOUNDED || records.size() < capacity) {
+        records.push_back(record);
+        return;
+    }
+    evict(records[head]);
+    records[head] = record;
+    head = (head + 1) % capacity;
+}
+
+std::size_t ActionLog::size() const {
+    return records.size();
+}
+
+ActionRecord const &ActionLog::at(std::size_t position) const {
+    return records[(head + position) % records.size()];
+}
+
+void ActionLog::appendLine(std::string &output, std::size_t position) const {
+    appendRecord(output, at(position));
+}
+
+void ActionLog::write(std::ostream &output, std::size_t position, std::size_t count) const {
+    std::string line;
+    for (std::size_t written = 0; written < count && position < records.size(); written++, position++) {
+        line.clear();
+        appendLine(line, position);
+        output.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+}
+
+std::string ActionLog::toString() const {
+    std::string output;
+    for (std::size_t position = 0; position < records.size(); position++) {
+        appendLine(output, position);
+    }
+    return output;
+}
+
+StringPool const &ActionLog::getStrings() const {
+    return strings;
+}
+
+void ActionLog::clear() {
+    strings = StringPool();
+    records.clear();
+    head = 0;
+    capacity = UNBOUNDED;
+    spillFile.reset();
+}
+
+//Private
+void ActionLog::appendRecord(std::string &output, const ActionRecord &record) const {
+    auto status = static_cast<ActionStatus>(record.status);
+    std::string first = hasFirstString(record.type) ? strings.get(record.first) : "";
+    std::string second = hasSecondString(record.type) ? strings.get(static_cast<std::uint32_t>(record.second)) : "";
+    switch (record.type) {
+        case CREATE_USER:
+            output.append(describe(CreateUser(first, second), status));
+            break;
+        case CHANGE_ACTIVE_USER:
+            output.append(describe(ChangeActiveUser(first), status));
+            break;
+        case DELETE_USER:
+            output.append(describe(DeleteUser(first), status));
+            break;
+        case DUPLICATE_USER:
+            output.append(describe(DuplicateUser(first, second), status));
+            break;
+        case PRINT_CONTENT_LIST:
+            output.append(describe(PrintContentList(), status));
+            break;
+        case PRINT_WATCH_HISTORY:
+            output.append(describe(PrintWatchHistory(), status));
+            break;
+        case PRINT_ACTIONS_LOG:
+            output.append(describe(PrintActionsLog(), status));
+            break;
+        case WATCH:
+            output.append(describe(Watch(static_cast<long>(record.second), static_cast<int>(record.first)), status));
+            break;
+        case EXIT:
+            output.append(describe(Exit(), status));
+            break;
+        case RECOMMEND:
+            output.append(describe(Recommend(static_cast<std::size_t>(record.second)), status));
+            break;
+        case RECOMMEND_ALL:
+            output.append(describe(RecommendAll(first), status));
+            break;
+    }
+    output.append("\n");
+}
+
+std::string ActionLog::describe(BaseAction &&action, ActionStatus status) {
+    action.status = status;
+    return action.toString();
+}
+
+void ActionLog::copy(const ActionLog &other) {
+    strings = other.strings;
+    records = other.records;
+    head = other.head;
+    capacity = other.capacity;
+}
+
+void ActionLog::move(ActionLog &&other) {
+    strings = std::move(other.strings);
+    records = std::move(other.records);
+    head = other.head;
+    capacity = other.capacity;
+    spillFile = std::move(other.spillFile);
+    other.clear();
+}
+
+void ActionLog::evict(const ActionRecord &record) {
+    spill(record);
+    if (hasFirstString(record.type)) {
+        strings.release(record.first);
+    }
+    if (hasSecondString(record.type)) {
+        strings.release(static_cast<std::uint32_t>(record.second));
+    }
+}
+
+void ActionLog::spill(const ActionRecord &record) {
+    if (!spillFile) {
+        return;
+    }
+    std::string line;
+    appendRecord(line, record);
+    *spillFile << line;
+}
+
+bool ActionLog::hasFirstString(ActionType type) {
+    return type <= DUPLICATE_USER || type == RECOMMEND_ALL;
+}
+
+bool ActionLog::hasSecondString(ActionType type) {
+    return type == CREATE_USER || type == DUPLICATE_USER;
+}
@@ -0,0 +1,122 @@
+#include "../include/ActionStats.h"
+#include <chrono>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ACTION_STATS_TSC
+#include <x86intrin.h>
+#endif
+
+static std::uint64_t steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//the ticks are calibrated against the steady clock since the start of the program, these stamps are taken
+//once by the static initialization
+static const std::uint64_t startTicks = ActionStats::now();
+static const std::uint64_t startNanoseconds = steadyNanoseconds();
+
+std::atomic<bool> ActionStats::enabled(true);
+std::atomic<ActionStats::Block *> ActionStats::blocks(nullptr);
+
+ActionStats::Block::Block() : buckets(), maxima(), next(nullptr) {}
+
+void ActionStats::setEnabled(bool set) {
+    enabled.store(set, std::memory_order_relaxed);
+}
+
+bool ActionStats::isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+std::uint64_t ActionStats::now() {
+#ifdef ACTION_STATS_TSC
+    return __rdtsc();
+#else
+    return steadyNanoseconds();
+#endif
+}
+
+void ActionStats::record(ActionType type, std::uint64_t ticks) {
+    Block &block = localBlock();
+    int bucket = ticks == 0 ? 0 : 64 - __builtin_clzll(ticks);
+    if (bucket >= BUCKETS) {
+        bucket = BUCKETS - 1;
+    }
+    //only this thread writes the block, a plain load and store is enough
+    std::atomic<std::uint64_t> &count = block.buckets[type][bucket];
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (ticks > block.maxima[type].load(std::memory_order_relaxed)) {
+        block.maxima[type].store(ticks, std::memory_order_relaxed);
+    }
+}
+
+std::string ActionStats::toString() {
+    return toString(nanosecondsPerTick());
+}
+
+std::string ActionStats::toString(double tickNanoseconds) {
+    std::string output;
+    for (int type = 0; type < TYPES; type++) {
+        std::uint64_t buckets[BUCKETS] = {};
+        std::uint64_t count = 0;
+        std::uint64_t maximum = 0;
+        for (Block *block = blocks.load(std::memory_order_acquire); block; block = block->next) {
+            for (int bucket = 0; bucket < BUCKETS; bucket++) {
+                std::uint64_t inBucket = block->buckets[type][bucket].load(std::memory_order_relaxed);
+                buckets[bucket] += inBucket;
+                count += inBucket;
+            }
+            std::uint64_t blockMaximum = block->maxima[type].load(std::memory_order_relaxed);
+            maximum = blockMaximum > maximum ? blockMaximum : maximum;
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        output += ACTION_COMMANDS[type] + std::string(": ") + std::to_string(count) + " actions";
+        const char *percentileNames[] = {"p50", "p99", "p999"};
+        const std::uint64_t perThousand[] = {500, 990, 999};
+        for (int percentile = 0; percentile < 3; percentile++) {
+            //the rank of the percentile, rounded up
+            std::uint64_t rank = (count * perThousand[percentile] + 999) / 1000;
+            std::uint64_t seen = 0;
+            int bucket = 0;
+            while (seen + buckets[bucket] < rank) {
+                seen += buckets[bucket];
+                bucket++;
+            }
+            std::uint64_t upperBound = bucket == 0 ? 0 : (static_cast<std::uint64_t>(1) << bucket) - 1;
+            upperBound = upperBound < maximum ? upperBound : maximum;
+            output += std::string(", ") + percentileNames[percentile] + " "
+                      + std::to_string(static_cast<std::uint64_t>(upperBound * tickNanoseconds)) + " ns";
+        }
+        output += ", max " + std::to_string(static_cast<std::uint64_t>(maximum * tickNanoseconds)) + " ns\n";
+    }
+    return output;
+}
+
+//Private
+double ActionStats::nanosecondsPerTick() {
+#ifdef ACTION_STATS_TSC
+    //never waits, which would stall every connection of a server: the whole run so far is the calibration,
+    //and the error of the stamps (tens of nanoseconds) is far below a bucket even after a millisecond
+    std::uint64_t ticks = now() - startTicks;
+    std::uint64_t elapsed = steadyNanoseconds() - startNanoseconds;
+    return ticks == 0 ? 1 : static_cast<double>(elapsed) / static_cast<double>(ticks);
+#else
+    return 1;
+#endif
+}
+
+ActionStats::Block &ActionStats::localBlock() {
+    static thread_local Block *local = nullptr;
+    if (!local) {
+        local = new Block();
+        local->next = blocks.load(std::memory_order_relaxed);
+        while (!blocks.compare_exchange_weak(local->next, local, std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        }
+    }
+    return *local;
+}
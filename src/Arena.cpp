@@ -0,0 +1,80 @@
+#include "../include/Arena.h"
+#include <cstdint>
+
+Arena::Arena(std::size_t firstBlockSize)
+        : firstBlockSize(firstBlockSize), nextBlockSize(firstBlockSize), blocks(), current(nullptr), end(nullptr),
+          capacity(0) {}
+
+Arena::Arena(Arena &&other)
+        : firstBlockSize(other.firstBlockSize), nextBlockSize(other.nextBlockSize), blocks(std::move(other.blocks)),
+          current(other.current), end(other.end), capacity(other.capacity) {
+    other.blocks.clear();
+    other.nextBlockSize = other.firstBlockSize;
+    other.current = nullptr;
+    other.end = nullptr;
+    other.capacity = 0;
+}
+
+Arena &Arena::operator=(Arena &&other) {
+    if (this != &other) {
+        release();
+        firstBlockSize = other.firstBlockSize;
+        nextBlockSize = other.nextBlockSize;
+        blocks = std::move(other.blocks);
+        current = other.current;
+        end = other.end;
+        capacity = other.capacity;
+        other.blocks.clear();
+        other.nextBlockSize = other.firstBlockSize;
+        other.current = nullptr;
+        other.end = nullptr;
+        other.capacity = 0;
+    }
+    return *this;
+}
+
+Arena::~Arena() {
+    release();
+}
+
+void *Arena::allocate(std::size_t size, std::size_t alignment) {
+    auto address = reinterpret_cast<std::uintptr_t>(current);
+    std::size_t padding = (alignment - address % alignment) % alignment;
+    if (!current || static_cast<std::size_t>(end - current) < padding + size) {
+        addBlock(size + alignment);
+        address = reinterpret_cast<std::uintptr_t>(current);
+        padding = (alignment - address % alignment) % alignment;
+    }
+    char *output = current + padding;
+    current = output + size;
+    return output;
+}
+
+void Arena::release() {
+    for (auto &block : blocks) {
+        ::operator delete(block);
+        block = nullptr;
+    }
+    blocks.clear();
+    nextBlockSize = firstBlockSize;
+    current = nullptr;
+    end = nullptr;
+    capacity = 0;
+}
+
+std::size_t Arena::getCapacity() const {
+    return capacity;
+}
+
+//Private
+void Arena::addBlock(std::size_t minimalSize) {
+    std::size_t size = nextBlockSize < minimalSize ? minimalSize : nextBlockSize;
+    if (nextBlockSize < MAX_BLOCK_SIZE) {
+        nextBlockSize *= 2;
+    }
+    auto *block = static_cast<char *>(::operator new(size));
+    blocks.push_back(block);
+    current = block;
+    end = block + size;
+    capacity += size;
+}
@@ -0,0 +1,81 @@
+#include "../include/BatchIO.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+
+//BufferedWriter
+BufferedWriter::BufferedWriter(int fd, std::size_t capacity) : std::streambuf(), fd(fd), buffer(capacity) {
+    setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+BufferedWriter::~BufferedWriter() {
+    flushAll();
+}
+
+bool BufferedWriter::flushAll() {
+    const char *data = pbase();
+    std::size_t left = pptr() - pbase();
+    while (left > 0) {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0) {
+            setp(buffer.data(), buffer.data() + buffer.size());
+            return false;
+        }
+        data += written;
+        left -= written;
+    }
+    setp(buffer.data(), buffer.data() + buffer.size());
+    return true;
+}
+
+BufferedWriter::int_type BufferedWriter::overflow(int_type ch) {
+    if (!flushAll()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize BufferedWriter::xsputn(const char *s, std::streamsize count) {
+    std::streamsize done = 0;
+    while (done < count) {
+        std::streamsize room = epptr() - pptr();
+        if (room == 0) {
+            if (!flushAll()) {
+                return done;
+            }
+            room = epptr() - pptr();
+        }
+        std::streamsize chunk = std::min(room, count - done);
+        std::memcpy(pptr(), s + done, chunk);
+        //pbump takes an int, chunk is at most the buffer capacity
+        pbump(static_cast<int>(chunk));
+        done += chunk;
+    }
+    return done;
+}
+
+int BufferedWriter::sync() {
+    return 0;
+}
+
+//ScriptReader
+ScriptReader::ScriptReader(const std::string &path) : std::streambuf(), content(), open(false) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return;
+    }
+    std::streamsize size = file.tellg();
+    file.seekg(0);
+    content.resize(size);
+    open = static_cast<bool>(file.read(content.data(), size));
+    setg(content.data(), content.data(), content.data() + content.size());
+}
+
+bool ScriptReader::isOpen() const {
+    return open;
+}
@@ -0,0 +1,469 @@
+#include "../include/Catalog.h"
+#include "../include/Watchable.h"
+#include <algorithm>
+#include <atomic>
+
+//a series usually has few episodes watched, its arena starts small
+static const std::size_t EPISODE_BLOCK_SIZE = 1024;
+
+//SERIES
+Series::Series(long firstId, const std::string &name, int episodeLength, const std::vector<int> &seasons,
+               const std::vector<TagId> &tags)
+        : firstId(firstId), name(name), episodeLength(episodeLength), seasonEnds(), tags(tags),
+          tagMask(TagDictionary::toMask(tags)), episodes(nullptr), episodeArena(EPISODE_BLOCK_SIZE),
+          episodesLock() {
+    long episodesSoFar = 0;
+    for (int seasonSize : seasons) {
+        episodesSoFar += seasonSize;
+        seasonEnds.push_back(episodesSoFar);
+    }
+}
+
+Series::Series(const Series &other)
+        : firstId(other.firstId), name(other.name), episodeLength(other.episodeLength),
+          seasonEnds(other.seasonEnds), tags(other.tags), tagMask(other.tagMask), episodes(nullptr),
+          episodeArena(EPISODE_BLOCK_SIZE), episodesLock() {}
+
+Series &Series::operator=(const Series &other) {
+    if (this != &other) {
+        clearEpisodes();
+        firstId = other.firstId;
+        name = other.name;
+        episodeLength = other.episodeLength;
+        seasonEnds = other.seasonEnds;
+        tags = other.tags;
+        tagMask = other.tagMask;
+    }
+    return *this;
+}
+
+Series::~Series() {
+    clearEpisodes();
+}
+
+long Series::getFirstId() const {
+    return firstId;
+}
+
+long Series::getLastId() const {
+    long episodesCount = seasonEnds.empty() ? 0 : seasonEnds.back();
+    return firstId + episodesCount - 1;
+}
+
+bool Series::contains(long id) const {
+    return id >= firstId && id <= getLastId();
+}
+
+std::string const &Series::getName() const {
+    return name;
+}
+
+int Series::getEpisodeLength() const {
+    return episodeLength;
+}
+
+std::vector<TagId> const &Series::getTags() const {
+    return tags;
+}
+
+std::vector<int> Series::getSeasons() const {
+    std::vector<int> seasons;
+    seasons.reserve(seasonEnds.size());
+    long episodesSoFar = 0;
+    for (long seasonEnd : seasonEnds) {
+        seasons.push_back(static_cast<int>(seasonEnd - episodesSoFar));
+        episodesSoFar = seasonEnd;
+    }
+    return seasons;
+}
+
+bool Series::checkInTags(TagId tag) const {
+    return TagDictionary::contains(tags, tagMask, tag);
+}
+
+void Series::remapTags(const std::vector<TagId> &newIds) {
+    clearEpisodes();
+    for (auto &tag : tags) {
+        tag = newIds[tag];
+    }
+    tagMask = TagDictionary::toMask(tags);
+}
+
+Episode *Series::getEpisode(long id) const {
+    std::atomic<Episode *> *slots = episodes.load(std::memory_order_acquire);
+    if (slots) {
+        Episode *found = slots[id - firstId].load(std::memory_order_acquire);
+        if (found) {
+            return found;
+        }
+    }
+    std::lock_guard<std::mutex> lock(episodesLock);
+    std::atomic<Episode *> &slot = episodeSlots()[id - firstId];
+    Episode *created = slot.load(std::memory_order_relaxed);
+    if (!created) {
+        int season, episode;
+        locate(id, season, episode);
+        created = episodeArena.create<Episode>(id, name, episodeLength, season, episode, tags);
+        slot.store(created, std::memory_order_release);
+    }
+    return created;
+}
+
+std::string Series::episodeToString(long id) const {
+    int season, episode;
+    locate(id, season, episode);
+    return name + " S" + std::to_string(season) + "E" + std::to_string(episode);
+}
+
+void Series::locate(long id, int &season, int &episode) const {
+    long offset = id - firstId;
+    auto seasonEnd = std::upper_bound(seasonEnds.begin(), seasonEnds.end(), offset);
+    long seasonStart = seasonEnd == seasonEnds.begin() ? 0 : *(seasonEnd - 1);
+    season = seasonEnd - seasonEnds.begin() + 1;
+    episode = offset - seasonStart + 1;
+}
+
+std::atomic<Episode *> *Series::episodeSlots() const {
+    std::atomic<Episode *> *slots = episodes.load(std::memory_order_relaxed);
+    if (!slots) {
+        slots = new std::atomic<Episode *>[getLastId() - firstId + 1]();
+        episodes.store(slots, std::memory_order_release);
+    }
+    return slots;
+}
+
+void Series::clearEpisodes() {
+    std::atomic<Episode *> *slots = episodes.exchange(nullptr);
+    if (slots) {
+        for (long offset = 0; offset <= getLastId() - firstId; offset++) {
+            Arena::destroy(slots[offset].load(std::memory_order_relaxed));
+        }
+        delete[] slots;
+    }
+    episodeArena.release();
+}
+
+//CATALOG
+//every catalog and every change of a catalog gets a version of its own
+static std::uint64_t nextVersion() {
+    static std::atomic<std::uint64_t> versions(0);
+    return ++versions;
+}
+
+Catalog::Catalog()
+        : arena(), movies(), series(), tagDictionary(), lengthIndex(), tagIndex(), columns(), image(), indexed(false),
+          nextId(1), version(nextVersion()) {}
+
+Catalog::Catalog(const Catalog &other)
+        : arena(), movies(), series(), tagDictionary(), lengthIndex(), tagIndex(), columns(), image(), indexed(false),
+          nextId(1), version(nextVersion()) {
+    copy(other);
+}
+
+Catalog &Catalog::operator=(const Catalog &other) {
+    if (this != &other) {
+        clear();
+        copy(other);
+    }
+    return *this;
+}
+
+Catalog::Catalog(Catalog &&other)
+        : arena(), movies(), series(), tagDictionary(), lengthIndex(), tagIndex(), columns(), image(), indexed(false),
+          nextId(1), version(nextVersion()) {
+    move(std::move(other));
+}
+
+Catalog &Catalog::operator=(Catalog &&other) {
+    if (this != &other) {
+        clear();
+        move(std::move(other));
+    }
+    return *this;
+}
+
+Catalog::~Catalog() {
+    clear();
+}
+
+//CatalogSink methods
+void Catalog::addMovie(const std::string &name, int length, const std::vector<std::string> &tags) {
+    addMovie(name, length, intern(tags));
+}
+
+void Catalog::addSeries(const std::string &name, int episodeLength, const std::vector<int> &seasons,
+                        const std::vector<std::string> &tags) {
+    addSeries(name, episodeLength, seasons, intern(tags));
+}
+
+void Catalog::finish() {
+    version = nextVersion();
+    std::vector<TagId> newIds = tagDictionary.sort();
+    for (auto &movie : movies) {
+        movie->remapTags(newIds);
+    }
+    for (auto &show : series) {
+        show->remapTags(newIds);
+    }
+    columns.build(movies, series);
+    indexed = size() >= MIN_INDEXED_SIZE;
+    if (indexed) {
+        lengthIndex.build(movies, series);
+        tagIndex.build(movies, series, tagDictionary.size());
+    }
+}
+
+TagId Catalog::addTag(const std::string &tag) {
+    return tagDictionary.intern(tag);
+}
+
+void Catalog::addMovie(const std::string &name, int length, const std::vector<TagId> &tags) {
+    movies.push_back(arena.create<Movie>(nextId, name, length, tags));
+    nextId++;
+    version = nextVersion();
+}
+
+void Catalog::addSeries(const std::string &name, int episodeLength, const std::vector<int> &seasons,
+                        const std::vector<TagId> &tags) {
+    auto *newSeries = arena.create<Series>(nextId, name, episodeLength, seasons, tags);
+    series.push_back(newSeries);
+    nextId = newSeries->getLastId() + 1;
+    version = nextVersion();
+}
+
+void Catalog::finish(ContentColumns &&columns, LengthIndex &&lengthIndex, TagIndex &&tagIndex,
+                     std::shared_ptr<const void> image) {
+    version = nextVersion();
+    this->columns = std::move(columns);
+    this->lengthIndex = std::move(lengthIndex);
+    this->tagIndex = std::move(tagIndex);
+    this->image = std::move(image);
+    indexed = size() >= MIN_INDEXED_SIZE;
+}
+
+std::vector<TagId> Catalog::intern(const std::vector<std::string> &tags) {
+    std::vector<TagId> tagIds;
+    tagIds.reserve(tags.size());
+    for (const auto &tag : tags) {
+        tagIds.push_back(tagDictionary.intern(tag));
+    }
+    return tagIds;
+}
+
+//Getters
+long Catalog::size() const {
+    return nextId - 1;
+}
+
+Watchable *Catalog::getWatchable(long id) const {
+    if (id < 1 || id > size()) {
+        return nullptr;
+    }
+    if (id <= static_cast<long>(movies.size())) {
+        return movies[id - 1];
+    }
+    return findSeries(id)->getEpisode(id);
+}
+
+std::vector<Movie *> const &Catalog::getMovies() const {
+    return movies;
+}
+
+std::vector<Series *> const &Catalog::getSeries() const {
+    return series;
+}
+
+TagDictionary const &Catalog::getTagDictionary() const {
+    return tagDictionary;
+}
+
+LengthIndex const &Catalog::getLengthIndex() const {
+    return lengthIndex;
+}
+
+TagIndex const &Catalog::getTagIndex() const {
+    return tagIndex;
+}
+
+ContentColumns const &Catalog::getColumns() const {
+    return columns;
+}
+
+bool Catalog::isIndexed() const {
+    return indexed;
+}
+
+std::uint64_t Catalog::getVersion() const {
+    return version;
+}
+
+//Recommendation searches
+long Catalog::findClosestLength(int average, const WatchedSet &watched) const {
+    if (indexed) {
+        return lengthIndex.findClosest(average, watched);
+    }
+    return columns.findClosestLength(average, watched);
+}
+
+long Catalog::findFirstWithTag(TagId tag, const WatchedSet &watched) const {
+    if (indexed) {
+        return tagIndex.findFirst(tag, watched);
+    }
+    if (tag < TagDictionary::MASK_BITS) {
+        return columns.findFirstWithTag(tag, watched);
+    }
+    //the tag is not in the masks, check the tag lists of the content instead
+    for (const auto &movie : movies) {
+        if (movie->checkInTags(tag) && !watched.contains(movie->getId())) {
+            return movie->getId();
+        }
+    }
+    for (const auto &show : series) {
+        if (show->checkInTags(tag)) {
+            long id = watched.firstMissing(show->getFirstId(), show->getLastId());
+            if (id != -1) {
+                return id;
+            }
+        }
+    }
+    return -1;
+}
+
+std::vector<long> Catalog::findClosestLengths(int average, const WatchedSet &watched, std::size_t k) const {
+    if (indexed) {
+        return lengthIndex.findClosest(average, watched, k);
+    }
+    return columns.findClosestLengths(average, watched, k);
+}
+
+void Catalog::collectWithTag(TagId tag, const WatchedSet &watched, std::size_t k, std::vector<long> &output) const {
+    if (indexed) {
+        tagIndex.collect(tag, watched, k, output);
+        return;
+    }
+    if (tag < TagDictionary::MASK_BITS) {
+        columns.collectWithTag(tag, watched, k, output);
+        return;
+    }
+    auto collect = [&](long id) {
+        if (!watched.contains(id) && std::find(output.begin(), output.end(), id) == output.end()) {
+            output.push_back(id);
+        }
+    };
+    for (const auto &movie : movies) {
+        if (output.size() < k && movie->checkInTags(tag)) {
+            collect(movie->getId());
+        }
+    }
+    for (const auto &show : series) {
+        if (show->checkInTags(tag)) {
+            for (long id = show->getFirstId(); id <= show->getLastId() && output.size() < k; id++) {
+                collect(id);
+            }
+        }
+    }
+}
+
+std::string Catalog::toString() const {
+    std::string output;
+    for (const auto &movie : movies) {
+        appendLine(output, movie->getId(), movie->toString(), movie->getLength(),
+                   movie->tagsToString(tagDictionary));
+    }
+    for (const auto &show : series) {
+        std::string tags = tagDictionary.toString(show->getTags());
+        for (long id = show->getFirstId(); id <= show->getLastId(); id++) {
+            appendLine(output, id, show->episodeToString(id), show->getEpisodeLength(), tags);
+        }
+    }
+    return output;
+}
+
+std::string Catalog::toString(const std::vector<long> &ids) const {
+    std::string output;
+    for (long id : ids) {
+        if (id <= static_cast<long>(movies.size())) {
+            const Movie *movie = movies[id - 1];
+            appendLine(output, id, movie->toString(), movie->getLength(), movie->tagsToString(tagDictionary));
+        } else {
+            const Series *show = findSeries(id);
+            appendLine(output, id, show->episodeToString(id), show->getEpisodeLength(),
+                       tagDictionary.toString(show->getTags()));
+        }
+    }
+    return output;
+}
+
+//Private
+Series *Catalog::findSeries(long id) const {
+    //the last series that starts at or before id
+    auto after = std::upper_bound(series.begin(), series.end(), id, [](long id, const Series *s) {
+        return id < s->getFirstId();
+    });
+    return *(after - 1);
+}
+
+void Catalog::appendLine(std::string &output, long id, const std::string &title, int length,
+                         const std::string &tags) {
+    output.append(std::to_string(id)).append(". ").append(title).append(" ").append(std::to_string(length))
+            .append(" minutes ").append(tags).append("\n");
+}
+
+void Catalog::clear() {
+    //the objects are destroyed in place, their memory is released with the arena
+    for (auto &movie : movies) {
+        Arena::destroy(movie);
+        movie = nullptr;
+    }
+    movies.clear();
+    for (auto &show : series) {
+        Arena::destroy(show);
+        show = nullptr;
+    }
+    series.clear();
+    arena.release();
+    tagDictionary = TagDictionary();
+    lengthIndex = LengthIndex();
+    tagIndex = TagIndex();
+    columns = ContentColumns();
+    image.reset();
+    indexed = false;
+    nextId = 1;
+    version = nextVersion();
+}
+
+void Catalog::copy(const Catalog &other) {
+    for (const auto &movie : other.movies) {
+        movies.push_back(arena.create<Movie>(*movie));
+    }
+    for (const auto &show : other.series) {
+        series.push_back(arena.create<Series>(*show));
+    }
+    tagDictionary = other.tagDictionary;
+    lengthIndex = other.lengthIndex;
+    tagIndex = other.tagIndex;
+    columns = other.columns;
+    image = other.image;
+    indexed = other.indexed;
+    nextId = other.nextId;
+    version = nextVersion();
+}
+
+void Catalog::move(Catalog &&other) {
+    arena = std::move(other.arena);
+    movies = std::move(other.movies);
+    series = std::move(other.series);
+    other.movies.clear();
+    other.series.clear();
+    tagDictionary = std::move(other.tagDictionary);
+    lengthIndex = std::move(other.lengthIndex);
+    tagIndex = std::move(other.tagIndex);
+    columns = std::move(other.columns);
+    image = std::move(other.image);
+    indexed = other.indexed;
+    other.indexed = false;
+    nextId = other.nextId;
+    other.nextId = 1;
+    version = nextVersion();
+    other.version = nextVersion();
+}
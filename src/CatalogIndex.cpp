@@ -0,0 +1,240 @@
+#include "../include/CatalogIndex.h"
+#include "../include/Catalog.h"
+#include "../include/Watchable.h"
+#include <algorithm>
+#include <limits>
+
+//LENGTH_INDEX
+LengthIndex::LengthIndex() : runs() {}
+
+void LengthIndex::build(const std::vector<Movie *> &movies, const std::vector<Series *> &series) {
+    std::vector<Run> built;
+    built.reserve(movies.size() + series.size());
+    for (const auto &movie : movies) {
+        built.push_back({movie->getLength(), {movie->getId(), movie->getId()}});
+    }
+    for (const auto &show : series) {
+        if (show->getLastId() >= show->getFirstId()) {
+            built.push_back({show->getEpisodeLength(), {show->getFirstId(), show->getLastId()}});
+        }
+    }
+    std::sort(built.begin(), built.end(), [](const Run &r1, const Run &r2) {
+        if (r1.length == r2.length) {
+            return r1.ids.first < r2.ids.first;
+        }
+        return r1.length < r2.length;
+    });
+    assign(MappedArray<Run>(std::move(built)));
+}
+
+void LengthIndex::assign(MappedArray<Run> &&runs) {
+    this->runs = std::move(runs);
+}
+
+MappedArray<LengthIndex::Run> const &LengthIndex::getRuns() const {
+    return runs;
+}
+
+long LengthIndex::findClosest(int average, const WatchedSet &watched) const {
+    //runs[0, left) are shorter than average, runs[right, size) are at least as long
+    auto right = static_cast<std::size_t>(std::lower_bound(runs.begin(), runs.end(), average,
+                                                           [](const Run &run, int length) {
+                                                               return run.length < length;
+                                                           }) - runs.begin());
+    std::size_t left = right;
+    const long far = std::numeric_limits<long>::max();
+
+    while (left > 0 || right < runs.size()) {
+        long leftDistance = left > 0 ? static_cast<long>(average) - runs[left - 1].length : far;
+        long rightDistance = right < runs.size() ? static_cast<long>(runs[right].length) - average : far;
+        long distance = std::min(leftDistance, rightDistance);
+
+        long leftId = -1;
+        long rightId = -1;
+        if (leftDistance == distance) {
+            std::size_t groupEnd = left;
+            int length = runs[left - 1].length;
+            while (left > 0 && runs[left - 1].length == length) {
+                left--;
+            }
+            leftId = firstUnwatched(left, groupEnd, watched);
+        }
+        if (rightDistance == distance) {
+            std::size_t groupBegin = right;
+            int length = runs[right].length;
+            while (right < runs.size() && runs[right].length == length) {
+                right++;
+            }
+            rightId = firstUnwatched(groupBegin, right, watched);
+        }
+
+        if (leftId != -1 && rightId != -1) {
+            return std::min(leftId, rightId);
+        }
+        if (leftId != -1 || rightId != -1) {
+            return std::max(leftId, rightId);
+        }
+    }
+    return -1;
+}
+
+std::vector<long> LengthIndex::findClosest(int average, const WatchedSet &watched, std::size_t k) const {
+    std::vector<long> output;
+    //the same walk as findClosest, which collects from the groups at every distance until it has k ids
+    auto right = static_cast<std::size_t>(std::lower_bound(runs.begin(), runs.end(), average,
+                                                           [](const Run &run, int length) {
+                                                               return run.length < length;
+                                                           }) - runs.begin());
+    std::size_t left = right;
+    const long far = std::numeric_limits<long>::max();
+
+    while (output.size() < k && (left > 0 || right < runs.size())) {
+        long leftDistance = left > 0 ? static_cast<long>(average) - runs[left - 1].length : far;
+        long rightDistance = right < runs.size() ? static_cast<long>(runs[right].length) - average : far;
+        long distance = std::min(leftDistance, rightDistance);
+        std::size_t remaining = k - output.size();
+
+        std::vector<long> atDistance;
+        if (leftDistance == distance) {
+            std::size_t groupEnd = left;
+            int length = runs[left - 1].length;
+            while (left > 0 && runs[left - 1].length == length) {
+                left--;
+            }
+            collectUnwatched(left, groupEnd, watched, remaining, atDistance);
+        }
+        if (rightDistance == distance) {
+            std::size_t groupBegin = right;
+            int length = runs[right].length;
+            while (right < runs.size() && runs[right].length == length) {
+                right++;
+            }
+            std::size_t middle = atDistance.size();
+            collectUnwatched(groupBegin, right, watched, remaining, atDistance);
+            std::inplace_merge(atDistance.begin(), atDistance.begin() + middle, atDistance.end());
+        }
+        if (atDistance.size() > remaining) {
+            atDistance.resize(remaining);
+        }
+        output.insert(output.end(), atDistance.begin(), atDistance.end());
+    }
+    return output;
+}
+
+long LengthIndex::firstUnwatched(std::size_t begin, std::size_t end, const WatchedSet &watched) const {
+    //the runs of a group are ordered by id, so the first unwatched id found is the lowest
+    for (std::size_t i = begin; i < end; i++) {
+        long id = watched.firstMissing(runs[i].ids.first, runs[i].ids.last);
+        if (id != -1) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+void LengthIndex::collectUnwatched(std::size_t begin, std::size_t end, const WatchedSet &watched,
+                                   std::size_t count, std::vector<long> &output) const {
+    std::size_t collected = 0;
+    for (std::size_t i = begin; i < end && collected < count; i++) {
+        for (long id = runs[i].ids.first; collected < count; id++) {
+            id = watched.firstMissing(id, runs[i].ids.last);
+            if (id == -1) {
+                break;
+            }
+            output.push_back(id);
+            collected++;
+        }
+    }
+}
+
+//TAG_INDEX
+TagIndex::TagIndex() : ranges(), starts() {}
+
+void TagIndex::build(const std::vector<Movie *> &movies, const std::vector<Series *> &series,
+                     std::size_t tagsCount) {
+    std::vector<std::vector<IdRange>> postings(tagsCount);
+    //movies and then series are visited by increasing ids, so every posting list stays ordered
+    for (const auto &movie : movies) {
+        for (TagId tag : movie->getTags()) {
+            add(postings[tag], movie->getId(), movie->getId());
+        }
+    }
+    for (const auto &show : series) {
+        if (show->getLastId() < show->getFirstId()) {
+            continue;
+        }
+        for (TagId tag : show->getTags()) {
+            add(postings[tag], show->getFirstId(), show->getLastId());
+        }
+    }
+
+    std::vector<IdRange> allRanges;
+    std::vector<std::uint32_t> allStarts;
+    allStarts.reserve(tagsCount + 1);
+    for (const auto &posting : postings) {
+        allStarts.push_back(static_cast<std::uint32_t>(allRanges.size()));
+        allRanges.insert(allRanges.end(), posting.begin(), posting.end());
+    }
+    allStarts.push_back(static_cast<std::uint32_t>(allRanges.size()));
+    assign(MappedArray<IdRange>(std::move(allRanges)), MappedArray<std::uint32_t>(std::move(allStarts)));
+}
+
+void TagIndex::assign(MappedArray<IdRange> &&ranges, MappedArray<std::uint32_t> &&starts) {
+    this->ranges = std::move(ranges);
+    this->starts = std::move(starts);
+}
+
+long TagIndex::findFirst(TagId tag, const WatchedSet &watched) const {
+    for (const IdRange *range = postingBegin(tag); range != postingEnd(tag); range++) {
+        long id = watched.firstMissing(range->first, range->last);
+        if (id != -1) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+void TagIndex::collect(TagId tag, const WatchedSet &watched, std::size_t k, std::vector<long> &output) const {
+    for (const IdRange *range = postingBegin(tag); range != postingEnd(tag); range++) {
+        for (long id = range->first; output.size() < k; id++) {
+            id = watched.firstMissing(id, range->last);
+            if (id == -1) {
+                break;
+            }
+            if (std::find(output.begin(), output.end(), id) == output.end()) {
+                output.push_back(id);
+            }
+        }
+        if (output.size() >= k) {
+            return;
+        }
+    }
+}
+
+MappedArray<IdRange> const &TagIndex::getRanges() const {
+    return ranges;
+}
+
+MappedArray<std::uint32_t> const &TagIndex::getStarts() const {
+    return starts;
+}
+
+void TagIndex::add(std::vector<IdRange> &posting, long first, long last) {
+    //a tag listed twice on the same content must not add it twice
+    if (!posting.empty() && posting.back().last >= first) {
+        return;
+    }
+    if (!posting.empty() && posting.back().last + 1 == first) {
+        posting.back().last = last;
+    } else {
+        posting.push_back({first, last});
+    }
+}
+
+const IdRange *TagIndex::postingBegin(TagId tag) const {
+    return tag + 1 < starts.size() ? ranges.data() + starts[tag] : nullptr;
+}
+
+const IdRange *TagIndex::postingEnd(TagId tag) const {
+    return tag + 1 < starts.size() ? ranges.data() + starts[tag + 1] : nullptr;
+}
@@ -0,0 +1,124 @@
+#include "../include/CatalogLoader.h"
+#include <fstream>
+#include <stdexcept>
+
+//CatalogSink
+CatalogSink::~CatalogSink() = default;
+
+void CatalogSink::finish() {}
+
+//CatalogSaxHandler
+CatalogSaxHandler::Entry::Entry() : name(), length(0), seasons(), tags() {}
+
+//Depths: 1 - the root object, 2 - the movies/tv_series array, 3 - an entry, 4 - the tags/seasons array of an entry.
+CatalogSaxHandler::CatalogSaxHandler(CatalogSink &sink)
+        : sink(sink), depth(0), section(NONE), field(), entry(), series() {}
+
+void CatalogSaxHandler::finish() {
+    for (const auto &descriptor : series) {
+        sink.addSeries(descriptor.name, descriptor.length, descriptor.seasons, descriptor.tags);
+    }
+    series.clear();
+    sink.finish();
+}
+
+bool CatalogSaxHandler::null() {
+    return true;
+}
+
+bool CatalogSaxHandler::boolean(bool) {
+    return true;
+}
+
+bool CatalogSaxHandler::number_integer(number_integer_t val) {
+    number(val);
+    return true;
+}
+
+bool CatalogSaxHandler::number_unsigned(number_unsigned_t val) {
+    number(val);
+    return true;
+}
+
+bool CatalogSaxHandler::number_float(number_float_t val, const string_t &) {
+    number(val);
+    return true;
+}
+
+void CatalogSaxHandler::number(long val) {
+    if (section == NONE) {
+        return;
+    }
+    if (depth == 3 && (field == "length" || field == "episode_length")) {
+        entry.length = val;
+    } else if (depth == 4 && field == "seasons") {
+        entry.seasons.push_back(val);
+    }
+}
+
+bool CatalogSaxHandler::string(string_t &val) {
+    if (section == NONE) {
+        return true;
+    }
+    if (depth == 3 && field == "name") {
+        entry.name = std::move(val);
+    } else if (depth == 4 && field == "tags") {
+        entry.tags.push_back(std::move(val));
+    }
+    return true;
+}
+
+bool CatalogSaxHandler::start_object(std::size_t) {
+    depth++;
+    if (depth == 3) {
+        entry = Entry();
+    }
+    return true;
+}
+
+bool CatalogSaxHandler::key(string_t &val) {
+    if (depth == 1) {
+        if (val == "movies") {
+            section = MOVIES;
+        } else if (val == "tv_series") {
+            section = SERIES;
+        } else {
+            section = NONE;
+        }
+    } else if (depth == 3) {
+        field = std::move(val);
+    }
+    return true;
+}
+
+bool CatalogSaxHandler::end_object() {
+    if (depth == 3 && section == MOVIES) {
+        sink.addMovie(entry.name, entry.length, entry.tags);
+    } else if (depth == 3 && section == SERIES) {
+        series.push_back(std::move(entry));
+    }
+    depth--;
+    return true;
+}
+
+bool CatalogSaxHandler::start_array(std::size_t) {
+    depth++;
+    return true;
+}
+
+bool CatalogSaxHandler::end_array() {
+    depth--;
+    return true;
+}
+
+bool CatalogSaxHandler::parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &ex) {
+    throw std::runtime_error(ex.what());
+}
+
+//CatalogLoader
+void CatalogLoader::loadJson(const std::string &configFilePath, CatalogSink &sink) {
+    std::ifstream ifs(configFilePath);
+    CatalogSaxHandler handler(sink);
+    nlohmann::json::sax_parse(ifs, &handler);
+    handler.finish();
+}
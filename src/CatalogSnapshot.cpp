@@ -0,0 +1,337 @@
+#include "../include/CatalogSnapshot.h"
+#include "../include/Watchable.h"
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char MAGIC[8] = {'S', 'P', 'L', 'F', 'L', 'I', 'X', '\0'};
+
+std::string CatalogSnapshot::pathFor(const std::string &configFilePath) {
+    return configFilePath + ".snap";
+}
+
+//Writing
+//appends the bytes of count elements to the payload
+template<typename T>
+static void appendSection(std::string &payload, const T *elements, std::size_t count) {
+    payload.append(reinterpret_cast<const char *>(elements), count * sizeof(T));
+}
+
+bool CatalogSnapshot::write(const std::string &configFilePath, const std::string &snapshotPath) {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    if (!fileStamp(configFilePath, header.sourceSize, header.sourceMtime)) {
+        return false;
+    }
+    Catalog catalog;
+    CatalogLoader::loadJson(configFilePath, catalog);
+
+    std::vector<StringRef> strings;
+    std::string bytes;
+    auto addString = [&](const std::string &str) {
+        strings.push_back({static_cast<std::uint32_t>(bytes.size()), static_cast<std::uint32_t>(str.size())});
+        bytes.append(str);
+        return static_cast<std::uint32_t>(strings.size() - 1);
+    };
+    std::vector<std::uint32_t> tagRefs;
+    auto addTags = [&](const std::vector<TagId> &tags) {
+        auto firstTag = static_cast<std::uint32_t>(tagRefs.size());
+        tagRefs.insert(tagRefs.end(), tags.begin(), tags.end());
+        return firstTag;
+    };
+
+    //the tags are sorted once the catalog is finished, so string i is the tag with id i
+    const TagDictionary &dictionary = catalog.getTagDictionary();
+    for (TagId tag = 0; tag < dictionary.size(); tag++) {
+        addString(dictionary.getTag(tag));
+    }
+    std::vector<MovieRecord> movies;
+    for (const Movie *movie : catalog.getMovies()) {
+        MovieRecord record = {addString(movie->getName()), movie->getLength(), addTags(movie->getTags()),
+                              static_cast<std::uint32_t>(movie->getTags().size())};
+        movies.push_back(record);
+    }
+    std::vector<SeriesRecord> series;
+    std::vector<std::int32_t> seasons;
+    for (const Series *show : catalog.getSeries()) {
+        std::vector<int> showSeasons = show->getSeasons();
+        SeriesRecord record = {addString(show->getName()), show->getEpisodeLength(),
+                               static_cast<std::uint32_t>(seasons.size()),
+                               static_cast<std::uint32_t>(showSeasons.size()), addTags(show->getTags()),
+                               static_cast<std::uint32_t>(show->getTags().size())};
+        seasons.insert(seasons.end(), showSeasons.begin(), showSeasons.end());
+        series.push_back(record);
+    }
+    //the runs are copied field by field, so their padding is zero and equal catalogs give equal snapshots
+    const MappedArray<LengthIndex::Run> &builtRuns = catalog.getLengthIndex().getRuns();
+    std::vector<LengthIndex::Run> runs(builtRuns.size());
+    if (!runs.empty()) {
+        std::memset(runs.data(), 0, runs.size() * sizeof(LengthIndex::Run));
+    }
+    for (std::size_t i = 0; i < runs.size(); i++) {
+        runs[i].length = builtRuns[i].length;
+        runs[i].ids = builtRuns[i].ids;
+    }
+
+    //pad the strings so the file size stays a multiple of 8
+    bytes.resize((bytes.size() + 7) & ~static_cast<std::size_t>(7), '\0');
+
+    const ContentColumns &columns = catalog.getColumns();
+    const TagIndex &tagIndex = catalog.getTagIndex();
+    std::string payload;
+    appendSection(payload, columns.getTagMasks().data(), columns.size());
+    appendSection(payload, runs.data(), runs.size());
+    appendSection(payload, tagIndex.getRanges().data(), tagIndex.getRanges().size());
+    appendSection(payload, columns.getLengths().data(), columns.size());
+    appendSection(payload, movies.data(), movies.size());
+    appendSection(payload, series.data(), series.size());
+    appendSection(payload, seasons.data(), seasons.size());
+    appendSection(payload, tagRefs.data(), tagRefs.size());
+    appendSection(payload, tagIndex.getStarts().data(), tagIndex.getStarts().size());
+    appendSection(payload, strings.data(), strings.size());
+    payload.append(bytes);
+
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(Header);
+    header.payloadSize = payload.size();
+    header.checksum = checksum(payload.data(), payload.size());
+    header.idCount = columns.size();
+    header.movieCount = movies.size();
+    header.seriesCount = series.size();
+    header.seasonCount = seasons.size();
+    header.tagRefCount = tagRefs.size();
+    header.tagCount = dictionary.size();
+    header.runCount = runs.size();
+    header.rangeCount = tagIndex.getRanges().size();
+    header.startCount = tagIndex.getStarts().size();
+    header.stringCount = strings.size();
+    header.stringBytes = bytes.size();
+
+    std::ofstream ofs(snapshotPath, std::ios::binary | std::ios::trunc);
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    ofs.write(payload.data(), payload.size());
+    return static_cast<bool>(ofs);
+}
+
+//Loading
+CatalogSnapshot::Sections::Sections(const Header &header, const char *payload)
+        : tagMasks(reinterpret_cast<const std::uint64_t *>(payload)),
+          runs(reinterpret_cast<const LengthIndex::Run *>(tagMasks + header.idCount)),
+          ranges(reinterpret_cast<const IdRange *>(runs + header.runCount)),
+          lengths(reinterpret_cast<const std::int32_t *>(ranges + header.rangeCount)),
+          movies(reinterpret_cast<const MovieRecord *>(lengths + header.idCount)),
+          series(reinterpret_cast<const SeriesRecord *>(movies + header.movieCount)),
+          seasons(reinterpret_cast<const std::int32_t *>(series + header.seriesCount)),
+          tagRefs(reinterpret_cast<const std::uint32_t *>(seasons + header.seasonCount)),
+          starts(tagRefs + header.tagRefCount),
+          strings(reinterpret_cast<const StringRef *>(starts + header.startCount)),
+          bytes(reinterpret_cast<const char *>(strings + header.stringCount)) {}
+
+bool CatalogSnapshot::load(const std::string &snapshotPath, const std::string &configFilePath, Catalog &catalog) {
+    std::uint64_t sourceSize;
+    std::int64_t sourceMtime;
+    if (!fileStamp(configFilePath, sourceSize, sourceMtime)) {
+        return false;
+    }
+    int fd = open(snapshotPath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    auto size = static_cast<std::size_t>(st.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    //unmapped once the catalog and all its copies are gone, or right away if the snapshot is rejected
+    std::shared_ptr<const void> image(mapped, [size](const void *memory) {
+        munmap(const_cast<void *>(memory), size);
+    });
+
+    const auto *data = static_cast<const char *>(mapped);
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    const char *payload = data + sizeof(Header);
+    bool valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+                 header.headerSize == sizeof(Header) && header.sourceSize == sourceSize &&
+                 header.sourceMtime == sourceMtime && header.payloadSize == size - sizeof(Header) &&
+                 header.idCount <= header.payloadSize && header.payloadSize == payloadSize(header) &&
+                 header.checksum == checksum(payload, header.payloadSize);
+    if (!valid) {
+        return false;
+    }
+    Sections sections(header, payload);
+    if (!validate(header, sections)) {
+        return false;
+    }
+    fill(header, sections, std::move(image), catalog);
+    return true;
+}
+
+bool CatalogSnapshot::validate(const Header &header, const Sections &sections) {
+    //the checksum only protects against corruption, so every reference is still checked before it is followed
+    for (std::uint32_t i = 0; i < header.stringCount; i++) {
+        const StringRef &ref = sections.strings[i];
+        if (ref.offset > header.stringBytes || ref.length > header.stringBytes - ref.offset) {
+            return false;
+        }
+    }
+    //the tag ids follow the lexicographic order of the tags
+    if (header.tagCount > header.stringCount) {
+        return false;
+    }
+    auto toString = [&](std::uint32_t index) {
+        return std::string(sections.bytes + sections.strings[index].offset, sections.strings[index].length);
+    };
+    for (std::uint32_t tag = 1; tag < header.tagCount; tag++) {
+        if (!(toString(tag - 1) < toString(tag))) {
+            return false;
+        }
+    }
+    for (std::uint32_t i = 0; i < header.tagRefCount; i++) {
+        if (sections.tagRefs[i] >= header.tagCount) {
+            return false;
+        }
+    }
+
+    std::uint64_t ids = header.movieCount;
+    for (std::uint32_t i = 0; i < header.movieCount; i++) {
+        const MovieRecord &movie = sections.movies[i];
+        if (movie.name >= header.stringCount || movie.firstTag > header.tagRefCount ||
+            movie.tagCount > header.tagRefCount - movie.firstTag) {
+            return false;
+        }
+    }
+    for (std::uint32_t i = 0; i < header.seriesCount; i++) {
+        const SeriesRecord &show = sections.series[i];
+        if (show.name >= header.stringCount || show.firstTag > header.tagRefCount ||
+            show.tagCount > header.tagRefCount - show.firstTag || show.firstSeason > header.seasonCount ||
+            show.seasonCount > header.seasonCount - show.firstSeason) {
+            return false;
+        }
+        for (std::uint32_t season = show.firstSeason; season < show.firstSeason + show.seasonCount; season++) {
+            if (sections.seasons[season] < 0) {
+                return false;
+            }
+            ids += sections.seasons[season];
+        }
+    }
+    //the columns have a row per id
+    if (ids != header.idCount) {
+        return false;
+    }
+
+    //the indexes are only built for large catalogs, and they only hold ids of the catalog
+    bool indexed = header.idCount >= static_cast<std::uint64_t>(Catalog::MIN_INDEXED_SIZE);
+    if (header.startCount != (indexed ? header.tagCount + 1 : 0) || (!indexed && header.runCount != 0)) {
+        return false;
+    }
+    auto validRange = [&](const IdRange &range) {
+        return range.first >= 1 && range.first <= range.last && static_cast<std::uint64_t>(range.last) <= ids;
+    };
+    for (std::uint32_t i = 0; i < header.runCount; i++) {
+        if (!validRange(sections.runs[i].ids)) {
+            return false;
+        }
+    }
+    for (std::uint32_t i = 0; i < header.rangeCount; i++) {
+        if (!validRange(sections.ranges[i])) {
+            return false;
+        }
+    }
+    for (std::uint32_t i = 0; i < header.startCount; i++) {
+        std::uint32_t previous = i == 0 ? 0 : sections.starts[i - 1];
+        if (sections.starts[i] < previous || sections.starts[i] > header.rangeCount) {
+            return false;
+        }
+    }
+    if (header.startCount == 0) {
+        return header.rangeCount == 0;
+    }
+    return sections.starts[header.startCount - 1] == header.rangeCount;
+}
+
+void CatalogSnapshot::fill(const Header &header, const Sections &sections, std::shared_ptr<const void> image,
+                           Catalog &catalog) {
+    auto toString = [&](std::uint32_t index) {
+        return std::string(sections.bytes + sections.strings[index].offset, sections.strings[index].length);
+    };
+    auto toTags = [&](std::uint32_t first, std::uint32_t count) {
+        return std::vector<TagId>(sections.tagRefs + first, sections.tagRefs + first + count);
+    };
+
+    for (std::uint32_t tag = 0; tag < header.tagCount; tag++) {
+        catalog.addTag(toString(tag));
+    }
+    for (std::uint32_t i = 0; i < header.movieCount; i++) {
+        const MovieRecord &movie = sections.movies[i];
+        catalog.addMovie(toString(movie.name), movie.length, toTags(movie.firstTag, movie.tagCount));
+    }
+    for (std::uint32_t i = 0; i < header.seriesCount; i++) {
+        const SeriesRecord &show = sections.series[i];
+        std::vector<int> showSeasons(sections.seasons + show.firstSeason,
+                                     sections.seasons + show.firstSeason + show.seasonCount);
+        catalog.addSeries(toString(show.name), show.episodeLength, showSeasons,
+                          toTags(show.firstTag, show.tagCount));
+    }
+
+    ContentColumns columns;
+    columns.assign(MappedArray<int>(sections.lengths, header.idCount),
+                   MappedArray<std::uint64_t>(sections.tagMasks, header.idCount));
+    LengthIndex lengthIndex;
+    lengthIndex.assign(MappedArray<LengthIndex::Run>(sections.runs, header.runCount));
+    TagIndex tagIndex;
+    tagIndex.assign(MappedArray<IdRange>(sections.ranges, header.rangeCount),
+                    MappedArray<std::uint32_t>(sections.starts, header.startCount));
+    catalog.finish(std::move(columns), std::move(lengthIndex), std::move(tagIndex), std::move(image));
+}
+
+//Helpers
+bool CatalogSnapshot::fileStamp(const std::string &path, std::uint64_t &size, std::int64_t &mtime) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    size = st.st_size;
+    mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+std::uint64_t CatalogSnapshot::checksum(const char *data, std::size_t size) {
+    //FNV-1a over 8 byte words, the payload is a multiple of 8 bytes so the byte loop is only a fallback
+    std::uint64_t hash = 14695981039346656037ULL;
+    std::size_t i = 0;
+    for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    for (; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::uint64_t CatalogSnapshot::payloadSize(const Header &header) {
+    return header.idCount * (sizeof(std::uint64_t) + sizeof(std::int32_t)) +
+           static_cast<std::uint64_t>(header.runCount) * sizeof(LengthIndex::Run) +
+           static_cast<std::uint64_t>(header.rangeCount) * sizeof(IdRange) +
+           static_cast<std::uint64_t>(header.movieCount) * sizeof(MovieRecord) +
+           static_cast<std::uint64_t>(header.seriesCount) * sizeof(SeriesRecord) +
+           static_cast<std::uint64_t>(header.seasonCount) * sizeof(std::int32_t) +
+           static_cast<std::uint64_t>(header.tagRefCount) * sizeof(std::uint32_t) +
+           static_cast<std::uint64_t>(header.startCount) * sizeof(std::uint32_t) +
+           static_cast<std::uint64_t>(header.stringCount) * sizeof(StringRef) +
+           header.stringBytes;
+}
@@ -0,0 +1,39 @@
+#include "../include/CommandTable.h"
+
+CommandTable::CommandTable() : entries() {}
+
+bool CommandTable::add(const std::string &name, Handler handler) {
+    if (name.empty() || !handler) {
+        return false;
+    }
+    std::size_t slot = slotOf(name.c_str(), name.size());
+    for (std::size_t probe = 0; probe < SLOTS; probe++, slot = (slot + 1) % SLOTS) {
+        Entry &entry = entries[slot];
+        if (!entry.handler) {
+            entry.name = name;
+            entry.handler = handler;
+            return true;
+        }
+        if (entry.name == name) {
+            return false;
+        }
+    }
+    return false;
+}
+
+CommandTable::Handler CommandTable::find(const std::string &name) const {
+    if (name.empty()) {
+        return nullptr;
+    }
+    std::size_t slot = slotOf(name.c_str(), name.size());
+    for (std::size_t probe = 0; probe < SLOTS; probe++, slot = (slot + 1) % SLOTS) {
+        const Entry &entry = entries[slot];
+        if (!entry.handler) {
+            return nullptr;
+        }
+        if (entry.name == name) {
+            return entry.handler;
+        }
+    }
+    return nullptr;
+}
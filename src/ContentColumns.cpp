@@ -0,0 +1,128 @@
+#include "../include/ContentColumns.h"
+#include "../include/Catalog.h"
+#include "../include/Watchable.h"
+#include "../include/LengthKernel.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+ContentColumns::ContentColumns() : lengths(), tagMasks(), kernelLengths(true) {}
+
+void ContentColumns::build(const std::vector<Movie *> &movies, const std::vector<Series *> &series) {
+    std::size_t rows = movies.size();
+    for (const auto &show : series) {
+        rows += show->getLastId() - show->getFirstId() + 1;
+    }
+    std::vector<int> builtLengths;
+    std::vector<std::uint64_t> builtTagMasks;
+    builtLengths.reserve(rows);
+    builtTagMasks.reserve(rows);
+
+    //movies and then series are visited by increasing ids, so row i is the id i + 1
+    for (const auto &movie : movies) {
+        builtLengths.push_back(movie->getLength());
+        builtTagMasks.push_back(TagDictionary::toMask(movie->getTags()));
+    }
+    for (const auto &show : series) {
+        std::size_t episodes = show->getLastId() - show->getFirstId() + 1;
+        builtLengths.insert(builtLengths.end(), episodes, show->getEpisodeLength());
+        builtTagMasks.insert(builtTagMasks.end(), episodes, TagDictionary::toMask(show->getTags()));
+    }
+    assign(MappedArray<int>(std::move(builtLengths)), MappedArray<std::uint64_t>(std::move(builtTagMasks)));
+}
+
+void ContentColumns::assign(MappedArray<int> &&lengths, MappedArray<std::uint64_t> &&tagMasks) {
+    this->lengths = std::move(lengths);
+    this->tagMasks = std::move(tagMasks);
+    kernelLengths = true;
+    for (int length : this->lengths) {
+        if (length < 0 || length > LengthKernel::MAX_LENGTH) {
+            kernelLengths = false;
+        }
+    }
+}
+
+std::size_t ContentColumns::size() const {
+    return lengths.size();
+}
+
+MappedArray<int> const &ContentColumns::getLengths() const {
+    return lengths;
+}
+
+MappedArray<std::uint64_t> const &ContentColumns::getTagMasks() const {
+    return tagMasks;
+}
+
+long ContentColumns::findClosestLength(int average, const WatchedSet &watched) const {
+    if (watched.isDense() && kernelLengths && average >= 0 && average <= LengthKernel::MAX_LENGTH) {
+        return LengthKernel::findClosest(lengths.data(), lengths.size(), average, watched.getBits());
+    }
+    long closest = -1;
+    long closestDistance = std::numeric_limits<long>::max();
+    for (std::size_t row = 0; row < lengths.size(); row++) {
+        long distance = std::labs(static_cast<long>(lengths[row]) - average);
+        //only a strictly closer row can win, which keeps the lowest id among equal distances
+        if (distance < closestDistance && !watched.contains(static_cast<long>(row) + 1)) {
+            closest = static_cast<long>(row) + 1;
+            closestDistance = distance;
+        }
+    }
+    return closest;
+}
+
+long ContentColumns::findFirstWithTag(TagId tag, const WatchedSet &watched) const {
+    const std::uint64_t bit = std::uint64_t(1) << tag;
+    for (std::size_t row = 0; row < tagMasks.size(); row++) {
+        if ((tagMasks[row] & bit) && !watched.contains(static_cast<long>(row) + 1)) {
+            return static_cast<long>(row) + 1;
+        }
+    }
+    return -1;
+}
+
+std::vector<long> ContentColumns::findClosestLengths(int average, const WatchedSet &watched, std::size_t k) const {
+    //a max heap of the best (distance, id) pairs so far, its top is the worst of them
+    std::vector<std::pair<long, long>> best;
+    if (k == 0) {
+        return {};
+    }
+    best.reserve(std::min(k, lengths.size()));
+    for (std::size_t row = 0; row < lengths.size(); row++) {
+        std::pair<long, long> candidate(std::labs(static_cast<long>(lengths[row]) - average),
+                                        static_cast<long>(row) + 1);
+        if (best.size() == k && !(candidate < best.front())) {
+            continue;
+        }
+        if (watched.contains(candidate.second)) {
+            continue;
+        }
+        if (best.size() == k) {
+            std::pop_heap(best.begin(), best.end());
+            best.back() = candidate;
+        } else {
+            best.push_back(candidate);
+        }
+        std::push_heap(best.begin(), best.end());
+    }
+    std::sort_heap(best.begin(), best.end());
+
+    std::vector<long> output;
+    output.reserve(best.size());
+    for (const auto &pair : best) {
+        output.push_back(pair.second);
+    }
+    return output;
+}
+
+void ContentColumns::collectWithTag(TagId tag, const WatchedSet &watched, std::size_t k,
+                                    std::vector<long> &output) const {
+    const std::uint64_t bit = std::uint64_t(1) << tag;
+    for (std::size_t row = 0; row < tagMasks.size() && output.size() < k; row++) {
+        auto id = static_cast<long>(row) + 1;
+        if ((tagMasks[row] & bit) && !watched.contains(id) &&
+            std::find(output.begin(), output.end(), id) == output.end()) {
+            output.push_back(id);
+        }
+    }
+}
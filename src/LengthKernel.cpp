@@ -0,0 +1,179 @@
+#include "../include/LengthKernel.h"
+#include <climits>
+#include <cstdlib>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LENGTH_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+static inline bool isWatched(const std::uint64_t *bits, std::size_t words, std::size_t id) {
+    std::size_t word = id / 64;
+    return word < words && ((bits[word] >> (id % 64)) & 1);
+}
+
+/**
+ * The minimal distance to average of the unwatched rows in [begin, count), at most best.
+ */
+static int scalarMinDistance(const int *lengths, std::size_t begin, std::size_t count, int average,
+                             const std::uint64_t *bits, std::size_t words, int best) {
+    for (std::size_t row = begin; row < count; row++) {
+        int distance = std::abs(lengths[row] - average);
+        if (distance < best && !isWatched(bits, words, row + 1)) {
+            best = distance;
+        }
+    }
+    return best;
+}
+
+/**
+ * @return the id of the first unwatched row at the given distance from average, or -1 if there is none.
+ */
+static long firstAtDistance(const int *lengths, std::size_t count, int average, const std::uint64_t *bits,
+                            std::size_t words, int distance) {
+    for (std::size_t row = 0; row < count; row++) {
+        if (std::abs(lengths[row] - average) == distance && !isWatched(bits, words, row + 1)) {
+            return static_cast<long>(row) + 1;
+        }
+    }
+    return -1;
+}
+
+#ifdef LENGTH_KERNEL_X86
+
+/*
+ * The vector kernels walk blocks of 8 ids starting at a multiple of 8, so the watched bits of a block are
+ * one byte of the bitmap (the bitmap words are little endian on x86). Rows hold the id row + 1, a block of
+ * ids [id, id + 8) is the rows [id - 1, id + 7). Blocks past the end of the bitmap are not watched at all.
+ */
+
+__attribute__((target("avx2")))
+static int avx2MinDistance(const int *lengths, std::size_t count, int average, const std::uint64_t *bits,
+                           std::size_t words) {
+    const auto *watchedBytes = reinterpret_cast<const unsigned char *>(bits);
+    const __m256i averages = _mm256_set1_epi32(average);
+    const __m256i far = _mm256_set1_epi32(INT_MAX);
+    const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i best = far;
+
+    std::size_t firstBlock = count < 7 ? count : 7;
+    int output = scalarMinDistance(lengths, 0, firstBlock, average, bits, words, INT_MAX);
+    std::size_t maskedEnd = words * 64 < count + 1 ? words * 64 : (count + 1) / 8 * 8;
+    std::size_t id = 8;
+    for (; id + 8 <= maskedEnd; id += 8) {
+        __m256i length = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lengths + id - 1));
+        __m256i distance = _mm256_abs_epi32(_mm256_sub_epi32(length, averages));
+        //the lanes of the watched rows are pushed to the far distance
+        __m256i watchedLanes = _mm256_and_si256(_mm256_set1_epi32(watchedBytes[id / 8]), lanes);
+        distance = _mm256_blendv_epi8(distance, far, _mm256_cmpeq_epi32(watchedLanes, lanes));
+        best = _mm256_min_epi32(best, distance);
+    }
+    for (; id + 8 <= count + 1; id += 8) {
+        __m256i length = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lengths + id - 1));
+        best = _mm256_min_epi32(best, _mm256_abs_epi32(_mm256_sub_epi32(length, averages)));
+    }
+
+    alignas(32) int bestLanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(bestLanes), best);
+    for (int lane : bestLanes) {
+        output = lane < output ? lane : output;
+    }
+    std::size_t tail = id - 1 > firstBlock ? id - 1 : firstBlock;
+    return scalarMinDistance(lengths, tail, count, average, bits, words, output);
+}
+
+//SSE2 has no 32 bit abs, min or blend, they are built from shifts, compares and masks
+__attribute__((target("sse2")))
+static int sse2MinDistance(const int *lengths, std::size_t count, int average, const std::uint64_t *bits,
+                           std::size_t words) {
+    const auto *watchedBytes = reinterpret_cast<const unsigned char *>(bits);
+    const __m128i averages = _mm_set1_epi32(average);
+    const __m128i far = _mm_set1_epi32(INT_MAX);
+    const __m128i lowLanes = _mm_setr_epi32(1, 2, 4, 8);
+    const __m128i highLanes = _mm_setr_epi32(16, 32, 64, 128);
+    __m128i best = far;
+
+    std::size_t firstBlock = count < 7 ? count : 7;
+    int output = scalarMinDistance(lengths, 0, firstBlock, average, bits, words, INT_MAX);
+    std::size_t maskedEnd = words * 64 < count + 1 ? words * 64 : (count + 1) / 8 * 8;
+    std::size_t id = 8;
+    for (; id + 8 <= count + 1; id += 8) {
+        __m128i watched = _mm_set1_epi32(id < maskedEnd ? watchedBytes[id / 8] : 0);
+        for (int half = 0; half < 2; half++) {
+            const __m128i &lanes = half == 0 ? lowLanes : highLanes;
+            __m128i length = _mm_loadu_si128(reinterpret_cast<const __m128i *>(lengths + id - 1 + half * 4));
+            __m128i difference = _mm_sub_epi32(length, averages);
+            __m128i sign = _mm_srai_epi32(difference, 31);
+            __m128i distance = _mm_sub_epi32(_mm_xor_si128(difference, sign), sign);
+            __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(watched, lanes), lanes);
+            distance = _mm_or_si128(_mm_and_si128(mask, far), _mm_andnot_si128(mask, distance));
+            __m128i closer = _mm_cmpgt_epi32(best, distance);
+            best = _mm_or_si128(_mm_and_si128(closer, distance), _mm_andnot_si128(closer, best));
+        }
+    }
+
+    alignas(16) int bestLanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i *>(bestLanes), best);
+    for (int lane : bestLanes) {
+        output = lane < output ? lane : output;
+    }
+    std::size_t tail = id - 1 > firstBlock ? id - 1 : firstBlock;
+    return scalarMinDistance(lengths, tail, count, average, bits, words, output);
+}
+
+#endif
+
+static LengthKernel::Level probe() {
+#ifdef LENGTH_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return LengthKernel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return LengthKernel::SSE2;
+    }
+#endif
+    return LengthKernel::SCALAR;
+}
+
+LengthKernel::Level LengthKernel::detect() {
+    static const Level level = probe();
+    return level;
+}
+
+const char *LengthKernel::levelName(Level level) {
+    switch (level) {
+        case AVX2:
+            return "avx2";
+        case SSE2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
+
+long LengthKernel::findClosest(const int *lengths, std::size_t count, int average,
+                               const std::vector<std::uint64_t> &watchedBits, Level level) {
+    const std::uint64_t *bits = watchedBits.data();
+    std::size_t words = watchedBits.size();
+
+    //the vector kernels find the minimal distance, then the lowest id at that distance is looked up
+    int distance;
+    switch (level) {
+#ifdef LENGTH_KERNEL_X86
+        case AVX2:
+            distance = avx2MinDistance(lengths, count, average, bits, words);
+            break;
+        case SSE2:
+            distance = sse2MinDistance(lengths, count, average, bits, words);
+            break;
+#endif
+        default:
+            distance = scalarMinDistance(lengths, 0, count, average, bits, words, INT_MAX);
+            break;
+    }
+    if (distance == INT_MAX) {
+        return -1;
+    }
+    return firstAtDistance(lengths, count, average, bits, words, distance);
+}
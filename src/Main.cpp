@@ -1,17 +1,147 @@
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <unistd.h>
 #include "../include/Session.h"
 #include "../include/Watchable.h"
+#include "../include/CatalogSnapshot.h"
+#include "../include/BatchIO.h"
+#include "../include/Server.h"
+#include "../include/ActionStats.h"
 
 using namespace std;
 
-int main(int argc, char **argv) {
+/**
+ * Applies the --log-capacity and --log-spill options to the session.
+ */
+static bool retainLog(Session &session, size_t logCapacity, const string &spillPath) {
+    if (!session.setLogRetention(logCapacity, spillPath)) {
+        cout << "could not open " << spillPath << endl;
+        return false;
+    }
+    return true;
+}
 
-    if (argc != 2) {
-        cout << "usage splflix input_file" << endl;
-        return 0;
+/**
+ * Writes the ActionStats to the --stats-dump file, if there is one.
+ */
+static bool dumpStats(const string &statsPath) {
+    if (statsPath.empty()) {
+        return true;
     }
+    ofstream statsFile(statsPath);
+    statsFile << ActionStats::toString();
+    if (!statsFile) {
+        cout << "could not write " << statsPath << endl;
+        return false;
+    }
+    return true;
+}
 
-    Session *s = new Session(argv[1]);
+/**
+ * Replays the commands in scriptPath without prompts, reading the whole script at once and buffering the output.
+ */
+static int runScript(const string &configFilePath, const string &scriptPath, size_t logCapacity,
+                     const string &spillPath) {
+    ScriptReader script(scriptPath);
+    if (!script.isOpen()) {
+        cout << "could not read " << scriptPath << endl;
+        return 1;
+    }
+    Session *s = new Session(configFilePath);
+    if (!retainLog(*s, logCapacity, spillPath)) {
+        delete s;
+        return 1;
+    }
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+    BufferedWriter output(STDOUT_FILENO);
+    streambuf *oldInput = cin.rdbuf(&script);
+    streambuf *oldOutput = cout.rdbuf(&output);
+
+    s->setInteractive(false);
     s->start();
+    delete s;
+
+    cin.rdbuf(oldInput);
+    cout.rdbuf(oldOutput);
     return 0;
 }
+
+int main(int argc, char **argv) {
+
+    if (argc == 3 && string(argv[1]) == "--snapshot") {
+        string snapshotPath = CatalogSnapshot::pathFor(argv[2]);
+        try {
+            if (!CatalogSnapshot::write(argv[2], snapshotPath)) {
+                cout << "could not write " << snapshotPath << endl;
+                return 1;
+            }
+        } catch (const std::exception &error) {
+            //a config file that is not valid json
+            cout << "could not write " << snapshotPath << ": " << error.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (argc == 3 && string(argv[1]) == "--connect") {
+        return Server::connect(argv[2]);
+    }
+
+    //input_file followed by pairs of an option and its value
+    string scriptPath, socketPath, spillPath, statsPath;
+    size_t logCapacity = ActionLog::UNBOUNDED;
+    bool valid = argc >= 2 && argc % 2 == 0;
+    for (int i = 2; valid && i + 1 < argc; i += 2) {
+        string option = argv[i];
+        if (option == "--script") {
+            scriptPath = argv[i + 1];
+        } else if (option == "--serve") {
+            socketPath = argv[i + 1];
+        } else if (option == "--log-capacity") {
+            char *end;
+            logCapacity = strtoul(argv[i + 1], &end, 10);
+            valid = *end == '\0';
+        } else if (option == "--log-spill") {
+            spillPath = argv[i + 1];
+        } else if (option == "--stats") {
+            ActionStats::setEnabled(string(argv[i + 1]) != "off");
+        } else if (option == "--stats-dump") {
+            statsPath = argv[i + 1];
+        } else {
+            valid = false;
+        }
+    }
+    if (!socketPath.empty() && (!scriptPath.empty() || !spillPath.empty())) {
+        valid = false;
+    }
+
+    if (!valid) {
+        cout << "usage splflix input_file [--log-capacity records] [--log-spill log_file]" << endl;
+        cout << "      every mode also takes [--stats on|off] [--stats-dump stats_file]" << endl;
+        cout << "      splflix input_file --script commands_file [--log-capacity records] [--log-spill log_file]"
+             << endl;
+        cout << "      splflix input_file --serve socket_file [--log-capacity records]" << endl;
+        cout << "      splflix --connect socket_file" << endl;
+        cout << "      splflix --snapshot input_file" << endl;
+        return 0;
+    }
+
+    int status;
+    if (!scriptPath.empty()) {
+        status = runScript(argv[1], scriptPath, logCapacity, spillPath);
+    } else if (!socketPath.empty()) {
+        Server server(Session::createContent(argv[1]), socketPath);
+        server.setLogCapacity(logCapacity);
+        status = server.run() ? 0 : 1;
+    } else {
+        Session *s = new Session(argv[1]);
+        if (!retainLog(*s, logCapacity, spillPath)) {
+            return 1;
+        }
+        s->start();
+        status = 0;
+    }
+    return dumpStats(statsPath) ? status : 1;
+}
@@ -0,0 +1,385 @@
+#include "../include/Server.h"
+#include "../include/Session.h"
+#include "../include/Catalog.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+//a connection that sends more than this without a line break is dropped
+static const std::size_t MAX_LINE = 1 << 16;
+static const int MAX_EVENTS = 256;
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void requestStop(int) {
+    stopRequested = 1;
+}
+
+/**
+ * Fills a unix socket address.
+ * @return false if the path does not fit in the address.
+ */
+static bool toAddress(const std::string &socketPath, sockaddr_un &address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return true;
+}
+
+/**
+ * Removes the socket file left at the address by a server that is no longer running, which would fail the bind.
+ * Nothing else is removed: a path that is not a socket or a socket that a server still accepts on.
+ * @param reason set to why the path is kept.
+ * @return true if the path is free to bind.
+ */
+static bool removeStaleSocket(const sockaddr_un &address, std::string &reason) {
+    struct stat st{};
+    if (lstat(address.sun_path, &st) == -1) {
+        reason = std::strerror(errno);
+        return errno == ENOENT;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        reason = "the path exists and is not a socket";
+        return false;
+    }
+    //a non blocking probe, so a server with a full backlog is not waited for
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (probe == -1) {
+        reason = std::strerror(errno);
+        return false;
+    }
+    int connected = connect(probe, reinterpret_cast<const sockaddr *>(&address), sizeof(address));
+    int error = errno;
+    ::close(probe);
+    if (connected == 0 || error != ECONNREFUSED) {
+        reason = connected == 0 || error == EAGAIN ? "another server listens on it" : std::strerror(error);
+        return false;
+    }
+    if (unlink(address.sun_path) == -1) {
+        reason = std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Writes the whole buffer to a blocking file descriptor.
+ */
+static bool writeAll(int fd, const char *data, std::size_t size) {
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+//Connection
+Server::Connection::Connection(int fd, Session *session)
+        : fd(fd), session(session), input(), output(), closing(false) {}
+
+//Server
+Server::Server(std::shared_ptr<const Catalog> content, const std::string &socketPath)
+        : content(std::move(content)), socketPath(socketPath), logCapacity(ActionLog::UNBOUNDED), listenFd(-1),
+          ownsSocket(false), epollFd(-1), connections(), lineBuffer(), replyBuffer() {}
+
+Server::~Server() {
+    while (!connections.empty()) {
+        close(*connections.begin()->second);
+    }
+    if (epollFd != -1) {
+        ::close(epollFd);
+    }
+    if (listenFd != -1) {
+        ::close(listenFd);
+    }
+    //only the socket this server bound, never a path it was refused
+    if (ownsSocket) {
+        unlink(socketPath.c_str());
+    }
+}
+
+void Server::setLogCapacity(std::size_t capacity) {
+    logCapacity = capacity;
+}
+
+bool Server::run() {
+    //every connection holds a descriptor, allow as many as the system lets this process have
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+    if (!listenOn()) {
+        return false;
+    }
+
+    //a client that disconnects must not kill the server, and a stop request must interrupt epoll_wait
+    std::signal(SIGPIPE, SIG_IGN);
+    struct sigaction stop{};
+    stop.sa_handler = requestStop;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, nullptr);
+    sigaction(SIGTERM, &stop, nullptr);
+
+    epoll_event events[MAX_EVENTS];
+    while (!stopRequested) {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        for (int i = 0; i < ready; i++) {
+            auto *connection = static_cast<Connection *>(events[i].data.ptr);
+            if (!connection) {
+                accept();
+                continue;
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP) && !(events[i].events & EPOLLIN)) {
+                close(*connection);
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                receive(*connection);
+            } else if (events[i].events & EPOLLOUT) {
+                if (!send(*connection) || (connection->closing && connection->output.empty())) {
+                    close(*connection);
+                } else {
+                    watchOutput(*connection);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool Server::listenOn() {
+    sockaddr_un address{};
+    if (!toAddress(socketPath, address)) {
+        std::cerr << "socket path is too long: " << socketPath << std::endl;
+        return false;
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd == -1) {
+        return false;
+    }
+    std::string reason;
+    if (!removeStaleSocket(address, reason)) {
+        std::cerr << "could not listen on " << socketPath << ": " << reason << std::endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1) {
+        std::cerr << "could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    ownsSocket = true;
+    if (listen(listenFd, SOMAXCONN) == -1) {
+        std::cerr << "could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd == -1) {
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) == 0;
+}
+
+void Server::accept() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            //EAGAIN once the backlog is empty, EMFILE leaves the rest of the backlog waiting
+            return;
+        }
+        auto *connection = new Connection(fd, new Session(content));
+        connection->session->setLogRetention(logCapacity, "");
+        connections[fd] = connection;
+
+        std::streambuf *oldOutput = std::cout.rdbuf(&replyBuffer);
+        connection->session->begin();
+        std::cout.rdbuf(oldOutput);
+        connection->output.append(replyBuffer.str());
+        replyBuffer.str("");
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = connection;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == -1 || !send(*connection)) {
+            close(*connection);
+            continue;
+        }
+        watchOutput(*connection);
+    }
+}
+
+void Server::receive(Connection &connection) {
+    char buffer[4096];
+    bool ended = false;
+    while (true) {
+        ssize_t received = read(connection.fd, buffer, sizeof(buffer));
+        if (received > 0) {
+            connection.input.append(buffer, received);
+            continue;
+        }
+        if (received == -1 && errno == EINTR) {
+            continue;
+        }
+        //a read of 0 means the client will send nothing more, a last line may lack its line break
+        ended = received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+        break;
+    }
+    if (ended && !connection.input.empty() && connection.input.back() != '\n') {
+        connection.input.push_back('\n');
+    }
+
+    handleLines(connection);
+    if (ended) {
+        connection.closing = true;
+    }
+    if (!connection.closing && connection.input.size() > MAX_LINE) {
+        close(connection);
+        return;
+    }
+    if (!send(connection) || (connection.closing && connection.output.empty())) {
+        close(connection);
+        return;
+    }
+    watchOutput(connection);
+}
+
+void Server::handleLines(Connection &connection) {
+    std::size_t begin = 0;
+    std::size_t end;
+    std::streambuf *oldInput = std::cin.rdbuf(&lineBuffer);
+    std::streambuf *oldOutput = std::cout.rdbuf(&replyBuffer);
+    while (!connection.closing && (end = connection.input.find('\n', begin)) != std::string::npos) {
+        lineBuffer.str(connection.input.substr(begin, end - begin));
+        std::cin.clear();
+        if (!connection.session->step()) {
+            connection.closing = true;
+        }
+        begin = end + 1;
+    }
+    std::cin.rdbuf(oldInput);
+    std::cin.clear();
+    std::cout.rdbuf(oldOutput);
+
+    connection.input.erase(0, begin);
+    connection.output.append(replyBuffer.str());
+    replyBuffer.str("");
+}
+
+bool Server::send(Connection &connection) {
+    std::size_t sent = 0;
+    while (sent < connection.output.size()) {
+        ssize_t written = ::send(connection.fd, connection.output.data() + sent, connection.output.size() - sent,
+                                 MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return false;
+        }
+        sent += written;
+    }
+    connection.output.erase(0, sent);
+    return true;
+}
+
+void Server::watchOutput(Connection &connection) {
+    epoll_event event{};
+    event.events = connection.output.empty() ? EPOLLIN : EPOLLIN | EPOLLOUT;
+    //a closing connection only waits for its output to drain
+    if (connection.closing) {
+        event.events = EPOLLOUT;
+    }
+    event.data.ptr = &connection;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+void Server::close(Connection &connection) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    ::close(connection.fd);
+    connections.erase(connection.fd);
+    delete connection.session;
+    delete &connection;
+}
+
+//Client
+int Server::connect(const std::string &socketPath) {
+    sockaddr_un address{};
+    if (!toAddress(socketPath, address)) {
+        std::cout << "socket path is too long: " << socketPath << std::endl;
+        return 1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1 || ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1) {
+        std::cout << "could not connect to " << socketPath << std::endl;
+        if (fd != -1) {
+            ::close(fd);
+        }
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    pollfd fds[2] = {{STDIN_FILENO, POLLIN, 0}, {fd, POLLIN, 0}};
+    char buffer[4096];
+    while (true) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[0].revents) {
+            ssize_t received = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (received > 0) {
+                if (!writeAll(fd, buffer, received)) {
+                    break;
+                }
+            } else {
+                //no more commands, keep printing the replies until the server is done
+                shutdown(fd, SHUT_WR);
+                fds[0].fd = -1;
+            }
+        }
+        if (fds[1].revents) {
+            ssize_t received = read(fd, buffer, sizeof(buffer));
+            if (received <= 0 || !writeAll(STDOUT_FILENO, buffer, received)) {
+                break;
+            }
+        }
+    }
+    ::close(fd);
+    return 0;
+}
@@ -1,18 +1,39 @@
 #include "../include/Session.h"
 #include "fstream"
 #include "../include/Watchable.h"
-#include "../include/json.hpp"
+#include "../include/CatalogLoader.h"
+#include "../include/CatalogSnapshot.h"
 #include "../include/User.h"
+#include "../include/CommandTable.h"
+#include "../include/ActionStats.h"
 #include <list>
+#include <cstdlib>
+#include <algorithm>
+
+static bool parseCount(const std::string &word, std::size_t &count) {
+    if (word.empty() || word[0] < '0' || word[0] > '9') {
+        return false;
+    }
+    char *end;
+    count = std::strtoul(word.c_str(), &end, 10);
+    return *end == '\0';
+}
 
 //Constructors and assignments
 Session::Session(const std::string &configFilePath)
-        : content(), actionsLog(), userMap(), activeUser(nullptr), endSession(false) {
-    createContent(configFilePath);
+        : content(createContent(configFilePath)), actionsLog(), userMap(), activeUser(nullptr), endSession(false),
+          interactive(true), stepping(false), pendingWatch(nullptr), actionStart(0) {
     createDefaultUser();
 }
 
-Session::Session(const Session &other) : content(), actionsLog(), userMap(), activeUser(nullptr), endSession(false) {
+Session::Session(std::shared_ptr<const Catalog> catalog)
+        : content(std::move(catalog)), actionsLog(), userMap(), activeUser(nullptr), endSession(false),
+          interactive(true), stepping(false), pendingWatch(nullptr), actionStart(0) {
+    createDefaultUser();
+}
+
+Session::Session(const Session &other) : content(), actionsLog(), userMap(), activeUser(nullptr), endSession(false),
+          interactive(true), stepping(false), pendingWatch(nullptr), actionStart(0) {
     copy(other);
 }
 
@@ -24,7 +45,8 @@ Session &Session::operator=(const Session &other) {
     return *this;
 }
 
-Session::Session(Session &&other) : content(), actionsLog(), userMap(), activeUser(nullptr), endSession(false) {
+Session::Session(Session &&other) : content(), actionsLog(), userMap(), activeUser(nullptr), endSession(false),
+          interactive(true), stepping(false), pendingWatch(nullptr), actionStart(0) {
     move(std::move(other));
 }
 
@@ -41,42 +63,12 @@ Session::~Session() {
 }
 
 //Create content and default user methods
-void Session::createContent(const std::string &configFilePath) {
-    std::fstream ifs(configFilePath);
-    nlohmann::json j = nlohmann::json::parse(ifs);
-    long id;
-    extractMoviesContent(j, id);
-
-    extractTVContent(j, id);
-}
-
-void Session::extractMoviesContent(nlohmann::json &j, long &id) {
-    id = 1;
-    nlohmann::json movies = j["movies"];
-    for (auto &mov : movies.items()) {
-        nlohmann::json movie = mov.value();
-        auto *newMovie = new Movie(id, movie["name"], movie["length"], movie["tags"]);
-        content.push_back(newMovie);
-        id++;
-    }
-}
-
-void Session::extractTVContent(const nlohmann::json &j, long id) {
-    nlohmann::json series = j["tv_series"];
-    for (auto &episode : series.items()) {
-        nlohmann::json seriesName = episode.value();
-        std::vector<int> seasons = seriesName["seasons"];
-        int seasonNumber = 1;
-        for (int y :seasons) {
-            for (int episodeNumber = 1; episodeNumber <= y; episodeNumber++) {
-                auto *newEpisode = new Episode(id, seriesName["name"], seriesName["episode_length"],
-                                               seasonNumber, episodeNumber, seriesName["tags"]);
-                content.push_back(newEpisode);
-                id++;
-            }
-            seasonNumber++;
-        }
+std::shared_ptr<const Catalog> Session::createContent(const std::string &configFilePath) {
+    auto catalog = std::make_shared<Catalog>();
+    if (!CatalogSnapshot::load(CatalogSnapshot::pathFor(configFilePath), configFilePath, *catalog)) {
+        CatalogLoader::loadJson(configFilePath, *catalog);
     }
+    return catalog;
 }
 
 void Session::createDefaultUser() {
@@ -93,13 +85,56 @@ void Session::start() {
     eventLoop();
 }
 
+void Session::begin() {
+    std::cout << "SPLFLIX is now on!" << std::endl;
+    setEndSession(false);
+    if (interactive) {
+        std::cout << "Please enter a command: ";
+    }
+}
+
+bool Session::step() {
+    stepping = true;
+    if (pendingWatch) {
+        std::string answer;
+        std::cin >> answer;
+        restartActionTimer();
+        pendingWatch->answer(*this, answer);
+        if (!pendingWatch->isWaitingForAnswer()) {
+            addActionToLog(*pendingWatch);
+            delete pendingWatch;
+            pendingWatch = nullptr;
+        }
+    } else {
+        std::string command;
+        //a malformed argument must end the command, not the session
+        try {
+            if (std::cin >> command) {
+                actionChooser(command);
+            }
+        } catch (const std::exception &) {
+            std::cout << "Error - Invalid input" << std::endl;
+        }
+    }
+    stepping = false;
+    if (!getEndSession() && !pendingWatch && interactive) {
+        std::cout << "Please enter a command: ";
+    }
+    return !getEndSession();
+}
+
 //-Private event loop methods
 void Session::eventLoop() {
     setEndSession(false);
     std::string command;
     while (!getEndSession()) {
-        std::cout << "Please enter a command: ";
-        std::cin >> command;
+        if (interactive) {
+            std::cout << "Please enter a command: ";
+        }
+        //the session also ends when the input does
+        if (!(std::cin >> command)) {
+            break;
+        }
         actionChooser(command);
         clearInputBuffer();
     }
@@ -110,28 +145,84 @@ void Session::clearInputBuffer() const {
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
+bool Session::readArgument(std::string &argument) const {
+    //the arguments of a command end with its line
+    while (std::cin.peek() == ' ' || std::cin.peek() == '\t') {
+        std::cin.get();
+    }
+    int next = std::cin.peek();
+    if (next == std::char_traits<char>::eof() || next == '\n' || next == '\r') {
+        return false;
+    }
+    return static_cast<bool>(std::cin >> argument);
+}
+
+bool Session::readCount(std::size_t &count) const {
+    std::string argument;
+    return readArgument(argument) && parseCount(argument, count);
+}
+
 void Session::actionChooser(const std::string &command) {
-    if (command == "createuser") {
-        createUser();
-    } else if (command == "changeuser") {
-        changeActiveUser();
-    } else if (command == "deleteuser") {
-        deleteUserAct();
-    } else if (command == "dupuser") {
-        duplicateUser();
-    } else if (command == "content") {
-        printContentList();
-    } else if (command == "watchhist") {
-        printWatchHistory();
-    } else if (command == "log") {
-        printActionsLog();
-    } else if (command == "watch") {
-        watch(-1);
-    } else if (command == "exit") {
-        exitSession();
-    } else {
+    CommandTable::Handler handler = commands().find(command);
+    if (!handler) {
         std::cout << "'" + command + "' is not a valid command" << std::endl;
+        return;
     }
+    restartActionTimer();
+    handler(*this);
+}
+
+//the built in commands that are not actions, registered after the commands of the action types
+static constexpr const char *OTHER_COMMANDS[] = {"stats"};
+static const std::size_t BUILT_IN_COUNT = ACTION_TYPES + sizeof(OTHER_COMMANDS) / sizeof(OTHER_COMMANDS[0]);
+
+//the built in commands, in the order of their handlers in commands()
+static constexpr const char *builtInCommand(std::size_t command) {
+    return command < ACTION_TYPES ? ACTION_COMMANDS[command] : OTHER_COMMANDS[command - ACTION_TYPES];
+}
+
+static constexpr std::size_t builtInSlot(std::size_t command) {
+    return CommandTable::slotOf(builtInCommand(command), CommandTable::lengthOf(builtInCommand(command)));
+}
+
+static constexpr bool slotDiffers(std::size_t command, std::size_t other) {
+    return other == BUILT_IN_COUNT || (builtInSlot(command) != builtInSlot(other) && slotDiffers(command, other + 1));
+}
+
+static constexpr bool slotsDiffer(std::size_t command) {
+    return command == BUILT_IN_COUNT || (slotDiffers(command, command + 1) && slotsDiffer(command + 1));
+}
+
+static_assert(slotsDiffer(0), "CommandTable::slotOf must place every built in command in its own slot");
+
+CommandTable &Session::commands() {
+    static CommandTable table = [] {
+        CommandTable::Handler handlers[] = {
+                [](Session &sess) { sess.createUser(); },
+                [](Session &sess) { sess.changeActiveUser(); },
+                [](Session &sess) { sess.deleteUserAct(); },
+                [](Session &sess) { sess.duplicateUser(); },
+                [](Session &sess) { sess.printContentList(); },
+                [](Session &sess) { sess.printWatchHistory(); },
+                [](Session &sess) { sess.printActionsLog(); },
+                [](Session &sess) { sess.watch(); },
+                [](Session &sess) { sess.exitSession(); },
+                [](Session &sess) { sess.recommend(); },
+                [](Session &sess) { sess.recommendAll(); },
+                [](Session &sess) { sess.printStats(); }
+        };
+        static_assert(sizeof(handlers) / sizeof(handlers[0]) == BUILT_IN_COUNT, "a handler for every command");
+        CommandTable builtIn;
+        for (std::size_t command = 0; command < BUILT_IN_COUNT; command++) {
+            builtIn.add(builtInCommand(command), handlers[command]);
+        }
+        return builtIn;
+    }();
+    return table;
+}
+
+bool Session::registerCommand(const std::string &name, CommandTable::Handler handler) {
+    return commands().add(name, handler);
 }
 
 
@@ -139,100 +230,165 @@ void Session::actionChooser(const std::string &command) {
 void Session::createUser() {
     std::string userName, algorithmType;
     std::cin >> userName >> algorithmType;
-    auto *create = new CreateUser(userName, algorithmType);
-    create->act(*this);
+    CreateUser create(userName, algorithmType);
+    create.act(*this);
     addActionToLog(create);
 }
 
 void Session::changeActiveUser() {
     std::string userName;
     std::cin >> userName;
-    auto *change = new ChangeActiveUser(userName);
-    change->act(*this);
+    ChangeActiveUser change(userName);
+    change.act(*this);
     addActionToLog(change);
 }
 
 void Session::deleteUserAct() {
     std::string userName;
     std::cin >> userName;
-    auto *deleted = new DeleteUser(userName);
-    deleted->act(*this);
+    DeleteUser deleted(userName);
+    deleted.act(*this);
     addActionToLog(deleted);
 }
 
 void Session::duplicateUser() {
     std::string oldUserName, newUserName;
     std::cin >> oldUserName >> newUserName;
-    auto *duplicate = new DuplicateUser(oldUserName, newUserName);
-    duplicate->act(*this);
+    DuplicateUser duplicate(oldUserName, newUserName);
+    duplicate.act(*this);
     addActionToLog(duplicate);
 }
 
 void Session::printWatchHistory() {
     //todo: check why this prints an address
-    auto *printHistory = new PrintWatchHistory;
-    printHistory->act(*this);
+    PrintWatchHistory printHistory;
+    printHistory.act(*this);
     addActionToLog(printHistory);
 }
 
 void Session::printContentList() {
-    auto *printContent = new PrintContentList();
-    printContent->act(*this);
+    PrintContentList printContent;
+    printContent.act(*this);
     addActionToLog(printContent);
 }
 
 void Session::printActionsLog() {
-    auto printLog = new PrintActionsLog();
-    printLog->act(*this);
+    std::string first;
+    std::size_t offset = 0, count = std::numeric_limits<std::size_t>::max();
+    if (readArgument(first)) {
+        bool valid = readCount(count);
+        if (first == "tail") {
+            offset = actionsLog.size() > count ? actionsLog.size() - count : 0;
+        } else {
+            valid = valid && parseCount(first, offset);
+        }
+        if (!valid) {
+            std::cout << "Error - Invalid input" << std::endl;
+            return;
+        }
+    }
+    PrintActionsLog printLog(offset, count);
+    printLog.act(*this);
     addActionToLog(printLog);
 }
 
-void Session::watch(long &&recommendId) {
-    long id = recommendId;
-    if (id < 0) {
-        std::string idString;
-        std::cin >> idString;
-        id = std::stol(idString);
-    }
+void Session::watch() {
+    std::string idString;
+    std::cin >> idString;
+    long id = std::stol(idString);
 
-    auto watchAct = new Watch(id);
-    watchAct->act(*this);
+    Watch watchAct(id);
+    if (stepping) {
+        watchAct.begin(*this);
+        if (watchAct.isWaitingForAnswer()) {
+            //the binge outlives the step
+            pendingWatch = new Watch(watchAct);
+            return;
+        }
+    } else {
+        watchAct.act(*this);
+    }
     addActionToLog(watchAct);
+}
+
+void Session::recommend() {
+    std::size_t k;
+    if (!readCount(k) || k == 0) {
+        std::cout << "Error - Invalid input" << std::endl;
+        return;
+    }
+    Recommend recommendAct(k);
+    recommendAct.act(*this);
+    addActionToLog(recommendAct);
+}
 
-    if (watchAct->getKeepWatching()) {
-        watch(watchAct->getNextId());
+void Session::recommendAll() {
+    std::string path;
+    if (!readArgument(path)) {
+        std::cout << "Error - Invalid input" << std::endl;
+        return;
     }
+    RecommendAll recommendAllAct(path);
+    recommendAllAct.act(*this);
+    addActionToLog(recommendAllAct);
+}
+
+void Session::printStats() {
+    std::string stats = ActionStats::toString();
+    //every line of the stats ends with its own line break
+    std::cout << (stats.empty() ? "No actions recorded\n" : stats) << std::flush;
 }
 
 void Session::exitSession() {
-    auto exitSession = new Exit();
-    exitSession->act(*this);
-    addActionToLog(exitSession);
+    Exit exitAct;
+    exitAct.act(*this);
+    addActionToLog(exitAct);
 }
 
 
 //newRecommendation methods
 //By length recommender
 Watchable *Session::GetRecommendationLength(const LengthRecommenderUser &user, const int average) {
-    Watchable *recommended = nullptr;
-    int closest = std::numeric_limits<int>::max();
-    for (auto const &toRecommend : content) {
-        if (!user.isInHistory(toRecommend) && abs(toRecommend->getLength() - average) < closest) {
-            closest = abs(toRecommend->getLength() - average);
-            recommended = toRecommend;
-        }
-    }
-    return recommended;
+    return getWatchable(content->findClosestLength(average, user.getWatched()));
 }
 
 //By genre recommender
-Watchable *Session::GetRecommendationGenre(const GenreRecommenderUser &user, const std::string &tag) {
-    for (auto const &watchable_ptr : content) {
-        if (watchable_ptr->checkInTags(tag) && !user.isInHistory(watchable_ptr)) {
-            return watchable_ptr;
-        }
+Watchable *Session::GetRecommendationGenre(const GenreRecommenderUser &user, TagId tag) {
+    return getWatchable(content->findFirstWithTag(tag, user.getWatched()));
+}
+
+std::vector<Watchable *> Session::GetRecommendationsLength(const LengthRecommenderUser &user, const int average,
+                                                          std::size_t k) {
+    std::vector<Watchable *> output;
+    for (long id : content->findClosestLengths(average, user.getWatched(), k)) {
+        output.push_back(getWatchable(id));
     }
-    return nullptr;
+    return output;
+}
+
+void Session::GetRecommendationsGenre(const GenreRecommenderUser &user, TagId tag, std::size_t k,
+                                      std::vector<long> &ids) {
+    content->collectWithTag(tag, user.getWatched(), k, ids);
+}
+
+std::vector<std::pair<User *, Watchable *>> Session::getAllRecommendations(ThreadPool &pool) {
+    std::vector<std::pair<const std::string *, User *>> users;
+    users.reserve(userMap.size());
+    for (auto const &pair : userMap) {
+        users.emplace_back(&pair.first, pair.second);
+    }
+    std::sort(users.begin(), users.end(), [](const std::pair<const std::string *, User *> &user1,
+                                             const std::pair<const std::string *, User *> &user2) {
+        return *user1.first < *user2.first;
+    });
+
+    std::vector<std::pair<User *, Watchable *>> recommendations(users.size());
+    pool.forEach(users.size(), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t user = begin; user < end; user++) {
+            recommendations[user] = std::make_pair(users[user].second, users[user].second->getRecommendation(*this));
+        }
+    });
+    return recommendations;
 }
 
 //userMap methods
@@ -261,33 +417,31 @@ bool Session::deleteUser(std::string &userName) {
 
 
 //actionsLog methods
-std::string Session::actionsLogToString() {
-    std::string output;
-    for (const auto &action: getActionsLog()) {
-        output.append(action->toString()).append("\n");
-    }
-    return output;
+bool Session::setLogRetention(std::size_t capacity, const std::string &spillPath) {
+    actionsLog.setCapacity(capacity);
+    return spillPath.empty() || actionsLog.setSpillPath(spillPath);
 }
 
 //-Private actionsLog method
-void Session::addActionToLog(BaseAction *action) {
-    actionsLog.push_back(action);
+void Session::addActionToLog(const BaseAction &action) {
+    actionsLog.add(action);
+    if (ActionStats::isEnabled()) {
+        ActionStats::record(action.getType(), ActionStats::now() - actionStart);
+    }
+}
+
+void Session::restartActionTimer() {
+    actionStart = ActionStats::isEnabled() ? ActionStats::now() : 0;
 }
 
 //Private
 void Session::clear() {
-    //clear content vector
-    for (auto &watchable_ptr: content) {
-        delete watchable_ptr;
-        watchable_ptr = nullptr;
-    }
-    content.clear();
+    //release content catalog
+    content.reset();
+
+    delete pendingWatch;
+    pendingWatch = nullptr;
 
-    //clear content vector
-    for (auto &action_ptr: actionsLog) {
-        delete action_ptr;
-        action_ptr = nullptr;
-    }
     actionsLog.clear();
 
     //clear content vector
@@ -301,13 +455,14 @@ void Session::clear() {
 
 void Session::copy(const Session &other) {
     this->endSession = other.endSession;
+    this->interactive = other.interactive;
 
-    for (auto &watchable : other.content) {
-        content.push_back(watchable->clone());
-    }
-    for (auto &action : other.actionsLog) {
-        actionsLog.push_back(action->clone());
+    //the catalog is immutable, copies share it
+    content = other.content;
+    if (other.pendingWatch) {
+        pendingWatch = static_cast<Watch *>(other.pendingWatch->clone());
     }
+    actionsLog = other.actionsLog;
     for (const auto &user : other.userMap) {
         std::string userName = user.first;
         auto pair = std::make_pair(userName, user.second->clone(userName));
@@ -320,14 +475,11 @@ void Session::copy(const Session &other) {
 
 void Session::move(Session &&other) {
     endSession = other.endSession;
-    for (auto &watchable : other.content) {
-        content.push_back(watchable);
-        watchable = nullptr;
-    }
-    for (auto &action : other.actionsLog) {
-        actionsLog.push_back(action);
-        action = nullptr;
-    }
+    interactive = other.interactive;
+    content = std::move(other.content);
+    pendingWatch = other.pendingWatch;
+    other.pendingWatch = nullptr;
+    actionsLog = std::move(other.actionsLog);
     for (auto &user : other.userMap) {
         this->userMap.insert(user);
         user.second = nullptr;
@@ -339,11 +491,11 @@ void Session::move(Session &&other) {
 }
 
 //Getters and setters
-std::vector<Watchable *> const &Session::getContent() const {
-    return content;
+Catalog const &Session::getContent() const {
+    return *content;
 }
 
-std::vector<BaseAction *> const &Session::getActionsLog() const {
+ActionLog const &Session::getActionsLog() const {
     return actionsLog;
 }
 
@@ -359,23 +511,6 @@ void Session::setActiveUser(User *newUser) {
     activeUser = newUser;
 }
 
-std::string Session::watchableVectorToString(const std::vector<Watchable *> &vec) {
-    std::string output;
-    std::string id;
-    std::string length;
-    std::string tags;
-
-    for (const auto &watchable: vec) {
-        id = std::to_string(watchable->getId());
-        length = std::to_string(watchable->getLength());
-        tags = watchable->tagsToString();
-
-        output.append(id).append(". ").append(watchable->toString()).append(" ").append(length)
-                .append(" minutes ").append(tags).append("\n");
-    }
-    return output;
-}
-
 bool Session::getEndSession() const {
     return endSession;
 }
@@ -384,13 +519,10 @@ void Session::setEndSession(bool set) {
     endSession = set;
 }
 
+void Session::setInteractive(bool set) {
+    interactive = set;
+}
+
 Watchable *Session::getWatchable(const long &id) {
-    Watchable *watchable;
-    try {
-        (watchable = content.at(id - 1));
-        return watchable;
-    }
-    catch (std::out_of_range &) {
-        return nullptr;
-    }
-}
\ No newline at end of file
+    return content->getWatchable(id);
+}
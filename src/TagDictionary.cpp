@@ -0,0 +1,81 @@
+#include "../include/TagDictionary.h"
+#include <algorithm>
+
+TagDictionary::TagDictionary() : tags(), ids() {}
+
+TagId TagDictionary::intern(const std::string &tag) {
+    auto found = ids.find(tag);
+    if (found != ids.end()) {
+        return found->second;
+    }
+    auto id = static_cast<TagId>(tags.size());
+    tags.push_back(tag);
+    ids.insert(std::make_pair(tag, id));
+    return id;
+}
+
+bool TagDictionary::find(const std::string &tag, TagId &id) const {
+    auto found = ids.find(tag);
+    if (found == ids.end()) {
+        return false;
+    }
+    id = found->second;
+    return true;
+}
+
+std::string const &TagDictionary::getTag(TagId id) const {
+    return tags[id];
+}
+
+std::size_t TagDictionary::size() const {
+    return tags.size();
+}
+
+std::vector<TagId> TagDictionary::sort() {
+    std::vector<TagId> order(tags.size());
+    for (TagId id = 0; id < order.size(); id++) {
+        order[id] = id;
+    }
+    std::sort(order.begin(), order.end(), [this](TagId a, TagId b) {
+        return tags[a] < tags[b];
+    });
+
+    std::vector<TagId> newIds(tags.size());
+    std::vector<std::string> sorted(tags.size());
+    for (TagId newId = 0; newId < order.size(); newId++) {
+        newIds[order[newId]] = newId;
+        sorted[newId] = std::move(tags[order[newId]]);
+        ids[sorted[newId]] = newId;
+    }
+    tags = std::move(sorted);
+    return newIds;
+}
+
+std::string TagDictionary::toString(const std::vector<TagId> &tagIds) const {
+    std::string tagsString = "[";
+    for (const auto &tag: tagIds) {
+        if (tag != tagIds.back()) {
+            tagsString.append(getTag(tag)).append(", ");
+        } else {
+            tagsString.append(getTag(tag)).append("]");
+        }
+    }
+    return tagsString;
+}
+
+std::uint64_t TagDictionary::toMask(const std::vector<TagId> &tagIds) {
+    std::uint64_t mask = 0;
+    for (TagId tag : tagIds) {
+        if (tag < MASK_BITS) {
+            mask |= std::uint64_t(1) << tag;
+        }
+    }
+    return mask;
+}
+
+bool TagDictionary::contains(const std::vector<TagId> &tagIds, std::uint64_t mask, TagId tag) {
+    if (tag < MASK_BITS) {
+        return (mask >> tag) & 1;
+    }
+    return std::find(tagIds.begin(), tagIds.end(), tag) != tagIds.end();
+}
@@ -0,0 +1,41 @@
+#include "../include/TagPopularity.h"
+#include <iterator>
+
+bool TagPopularity::Order::operator()(const std::pair<int, TagId> &p1, const std::pair<int, TagId> &p2) const {
+    if (p1.first == p2.first) {
+        return p1.second < p2.second;
+    }
+    return p1.first > p2.first;
+}
+
+TagPopularity::TagPopularity() : counts(), ordered() {}
+
+bool TagPopularity::add(TagId tag) {
+    int &count = counts[tag];
+    bool moved = true;
+    if (count > 0) {
+        auto position = ordered.find(std::make_pair(count, tag));
+        moved = position != ordered.begin() && Order()(std::make_pair(count + 1, tag), *std::prev(position));
+        ordered.erase(position);
+    }
+    count++;
+    ordered.insert(std::make_pair(count, tag));
+    return moved;
+}
+
+int TagPopularity::getCount(TagId tag) const {
+    auto found = counts.find(tag);
+    return found == counts.end() ? 0 : found->second;
+}
+
+std::size_t TagPopularity::size() const {
+    return counts.size();
+}
+
+TagPopularity::const_iterator TagPopularity::begin() const {
+    return ordered.begin();
+}
+
+TagPopularity::const_iterator TagPopularity::end() const {
+    return ordered.end();
+}
@@ -0,0 +1,100 @@
+#include "../include/ThreadPool.h"
+#include <algorithm>
+
+//every thread gets this many chunks of a loop on average, so uneven chunks even out
+static const std::size_t CHUNKS_PER_THREAD = 16;
+
+ThreadPool::ThreadPool(std::size_t threads)
+        : workers(), running(), lock(), wake(), done(), task(nullptr), count(0), chunk(1), next(0), busy(0),
+          generation(0), failure(), stopping(false) {
+    for (std::size_t worker = 1; worker < threads; worker++) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::size() const {
+    return workers.size() + 1;
+}
+
+void ThreadPool::forEach(std::size_t count, const Task &task) {
+    if (count == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> loop(running);
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        this->task = &task;
+        this->count = count;
+        chunk = std::max<std::size_t>(1, count / (size() * CHUNKS_PER_THREAD));
+        next.store(0, std::memory_order_relaxed);
+        busy = workers.size();
+        failure = nullptr;
+        generation++;
+    }
+    wake.notify_all();
+    runChunks();
+
+    std::exception_ptr thrown;
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [this] { return busy == 0; });
+        this->task = nullptr;
+        thrown = failure;
+        failure = nullptr;
+    }
+    if (thrown) {
+        std::rethrow_exception(thrown);
+    }
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+//Private
+void ThreadPool::work() {
+    std::uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        runChunks();
+        std::lock_guard<std::mutex> guard(lock);
+        if (--busy == 0) {
+            done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runChunks() {
+    std::size_t begin;
+    while ((begin = next.fetch_add(chunk, std::memory_order_relaxed)) < count) {
+        try {
+            (*task)(begin, std::min(begin + chunk, count));
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(lock);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+            //the other threads find no more chunks
+            next.store(count, std::memory_order_relaxed);
+        }
+    }
+}
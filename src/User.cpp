@@ -5,10 +5,10 @@
 
 //USER
 User::User(const std::string &name)
-        : history(), name(name) {}
+        : history(), watched(), cache(), name(name) {}
 
 User::User(const User &other)
-        : history(), name(other.name) {
+        : history(), watched(), cache(), name(other.name) {
     copy(other);
 }
 
@@ -21,7 +21,7 @@ User &User::operator=(const User &other) {
 }
 
 User::User(User &&other)
-        : history(), name(other.name) {
+        : history(), watched(), cache(), name(other.name) {
     move(std::move(other));
 }
 
@@ -42,41 +42,98 @@ std::string User::getName() const {
 }
 
 bool User::isInHistory(const Watchable *watchable) const {
-    for (const auto &content: history) {
-        if (*content == *watchable)
-            return true;
+    return watched->contains(watchable->getId());
+}
+
+bool User::isInHistory(long id) const {
+    return watched->contains(id);
+}
+
+WatchedSet const &User::getWatched() const {
+    return *watched;
+}
+
+Watchable *User::getRecommendation(Session &s) {
+    if (isCached(s, 1)) {
+        return cache.best.empty() ? nullptr : cache.best.front();
+    }
+    Watchable *recommendation = findRecommendation(s);
+    cache.best.clear();
+    if (recommendation) {
+        cache.best.push_back(recommendation);
+    }
+    cache.k = 1;
+    cache.catalogVersion = s.getContent().getVersion();
+    return recommendation;
+}
+
+std::vector<Watchable *> User::getRecommendations(Session &s, std::size_t k) {
+    if (isCached(s, k)) {
+        return std::vector<Watchable *>(cache.best.begin(), cache.best.begin() + std::min(k, cache.best.size()));
     }
-    return false;
+    cache.best = findRecommendations(s, k);
+    cache.k = k;
+    cache.catalogVersion = s.getContent().getVersion();
+    return cache.best;
 }
 
 void User::addToHistory(Watchable *watchable) {
-    history.push_back(watchable);
+    history.write().push_back(watchable->getId());
+    watched.write().add(watchable->getId());
+    //the other candidates keep their order, so without the watched one the rest are still the best ones
+    long id = watchable->getId();
+    auto found = std::find_if(cache.best.begin(), cache.best.end(), [id](const Watchable *recommendation) {
+        return recommendation->getId() == id;
+    });
+    if (found != cache.best.end()) {
+        if (cache.best.size() == cache.k) {
+            cache.k--;
+        }
+        cache.best.erase(found);
+    }
 }
 
-std::vector<Watchable *> const &User::getHistory() const {
-    return history;
+std::vector<long> const &User::getHistory() const {
+    return *history;
+}
+
+//protected
+void User::invalidateRecommendations() {
+    cache.k = 0;
+    cache.best.clear();
 }
 
 //private
-void User::copy(const User &other) {
-    for (auto watchable_ptr : other.history) {
-        history.push_back(watchable_ptr->clone());
+User::RecommendationCache::RecommendationCache() : catalogVersion(0), k(0), best() {}
+
+bool User::isCached(const Session &s, std::size_t k) const {
+    if (cache.k == 0 || cache.catalogVersion != s.getContent().getVersion()) {
+        return false;
     }
+    //fewer than cache.k recommendations are all there are
+    return k <= cache.k || cache.best.size() < cache.k;
+}
+
+void User::copy(const User &other) {
+    history = other.history;
+    watched = other.watched;
+    //the copy computes its own recommendations when asked
+    invalidateRecommendations();
 }
 
 void User::clear() {
-    for (auto &watchable_ptr : history) {
-        delete watchable_ptr;
-        watchable_ptr = nullptr;
-    }
-    history.clear();
+    history.reset();
+    watched.reset();
+    invalidateRecommendations();
 }
 
 void User::move(User &&other) {
-    for (auto &watchable_ptr : other.history) {
-        history.push_back(watchable_ptr);
-        watchable_ptr = nullptr;
-    }
+    history = other.history;
+    other.history.reset();
+    watched = other.watched;
+    other.watched.reset();
+    cache = std::move(other.cache);
+    other.invalidateRecommendations();
 }
 
 
@@ -117,11 +174,15 @@ LengthRecommenderUser::~LengthRecommenderUser() = default;
  * @param s session
  * @return a pointer the next content to be recommended to the user
  */
-Watchable *LengthRecommenderUser::getRecommendation(Session &s) {
+Watchable *LengthRecommenderUser::findRecommendation(Session &s) {
     return s.GetRecommendationLength(*this, average);
 }
 
 
+std::vector<Watchable *> LengthRecommenderUser::findRecommendations(Session &s, std::size_t k) {
+    return s.GetRecommendationsLength(*this, average, k);
+}
+
 User *LengthRecommenderUser::clone(std::string &name) {
     auto *clone = new LengthRecommenderUser(name);
     *clone = *this;
@@ -130,12 +191,16 @@ User *LengthRecommenderUser::clone(std::string &name) {
 
 void LengthRecommenderUser::addToHistory(Watchable *watchable) {
     User::addToHistory(watchable);
+    int previous = average;
     recomputeAverage(watchable->getLength());
+    if (average != previous) {
+        invalidateRecommendations();
+    }
 }
 
 void LengthRecommenderUser::recomputeAverage(int length) {
     int sum = average + length;
-    int amountOfWatchables = history.size();
+    int amountOfWatchables = history->size();
     average = sum / amountOfWatchables;
 }
 
@@ -176,13 +241,33 @@ User *RerunRecommenderUser::clone(std::string &name) {
     return clone;
 }
 
-Watchable *RerunRecommenderUser::getRecommendation(Session &s) {
-    return history.at(currentIndex);
+Watchable *RerunRecommenderUser::findRecommendation(Session &s) {
+    //nothing to rerun before the first watch
+    if (currentIndex < 0) {
+        return nullptr;
+    }
+    return s.getWatchable(history->at(currentIndex));
+}
+
+std::vector<Watchable *> RerunRecommenderUser::findRecommendations(Session &s, std::size_t k) {
+    //the current rerun, then the content watched before it, each once
+    std::vector<Watchable *> output;
+    std::vector<long> ids;
+    for (int index = currentIndex; index >= 0 && ids.size() < k; index--) {
+        long id = history->at(index);
+        if (std::find(ids.begin(), ids.end(), id) == ids.end()) {
+            ids.push_back(id);
+            output.push_back(s.getWatchable(id));
+        }
+    }
+    return output;
 }
 
 void RerunRecommenderUser::addToHistory(Watchable *watchable) {
     User::addToHistory(watchable);
     incrementCurrentIndex();
+    //the rerun moves to the next content in the history
+    invalidateRecommendations();
 }
 
 void RerunRecommenderUser::incrementCurrentIndex() { currentIndex++; }
@@ -224,8 +309,8 @@ User *GenreRecommenderUser::clone(std::string &name) {
     return clone;
 }
 
-Watchable *GenreRecommenderUser::getRecommendation(Session &s) {
-    for (auto const &pair : mostPopularTags) {
+Watchable *GenreRecommenderUser::findRecommendation(Session &s) {
+    for (auto const &pair : *mostPopularTags) {
         Watchable *recommend = s.GetRecommendationGenre(*this, pair.second);
         if (recommend != nullptr) {
             return recommend;
@@ -234,39 +319,38 @@ Watchable *GenreRecommenderUser::getRecommendation(Session &s) {
     return nullptr;
 }
 
-void GenreRecommenderUser::addTag(const std::string &tag) {
-    bool changed = false;
-    for (auto &pair : mostPopularTags) {
-        if (pair.second == tag) {
-            pair.first++;
-            changed = true;
+std::vector<Watchable *> GenreRecommenderUser::findRecommendations(Session &s, std::size_t k) {
+    //the unwatched content of the most popular tag first, then of the next tags
+    std::vector<long> ids;
+    for (auto const &pair : *mostPopularTags) {
+        if (ids.size() >= k) {
             break;
         }
+        s.GetRecommendationsGenre(*this, pair.second, k, ids);
     }
-    if (!changed) {
-        mostPopularTags.push_back(std::make_pair(1, tag));
+    std::vector<Watchable *> output;
+    for (long id : ids) {
+        output.push_back(s.getWatchable(id));
     }
-    sortPopularTags();
+    return output;
 }
 
-bool GenreRecommenderUser::sortInRevLex(const std::pair<int, std::string> &p1, const std::pair<int, std::string> &p2) {
-    if (p1.first == p2.first) {
-        return p1.second < p2.second;
-    }
-    return p1.first > p2.first;
-}
-
-void GenreRecommenderUser::sortPopularTags() {
-    std::sort(mostPopularTags.begin(), mostPopularTags.end(), sortInRevLex);
+bool GenreRecommenderUser::addTag(TagId tag) {
+    return mostPopularTags.write().add(tag);
 }
 
 void GenreRecommenderUser::addToHistory(Watchable *watchable) {
     User::addToHistory(watchable);
-    addTags(watchable);
+    //the recommendations follow the order of the tags, not their counts
+    if (addTags(watchable)) {
+        invalidateRecommendations();
+    }
 }
 
-void GenreRecommenderUser::addTags(Watchable *watchable) {
-    for (auto &tag : watchable->getTags()) {
-        addTag(tag);
+bool GenreRecommenderUser::addTags(Watchable *watchable) {
+    bool moved = false;
+    for (TagId tag : watchable->getTags()) {
+        moved = addTag(tag) || moved;
     }
+    return moved;
 }
@@ -3,8 +3,8 @@
 
 //WATCHABLE
 //Constructors, operators and destructor
-Watchable::Watchable(long id, int length, const std::vector<std::string> &tags) : id(id), length(length),
-                                                                                  tags(tags) {}
+Watchable::Watchable(long id, int length, const std::vector<TagId> &tags) : id(id), length(length), tags(tags),
+                                                                           tagMask(TagDictionary::toMask(tags)) {}
 
 Watchable::Watchable(const Watchable &watchable) = default;
 
@@ -12,6 +12,7 @@ Watchable &Watchable::operator=(const Watchable &other) {
     if (&other != this) {
         length = other.length;
         tags = other.tags;
+        tagMask = other.tagMask;
     }
     return *this;
 }
@@ -31,31 +32,29 @@ long Watchable::getId() const {
     return id;
 }
 
-std::vector<std::string> const &Watchable::getTags() const {
+std::vector<TagId> const &Watchable::getTags() const {
     return tags;
 }
 
-std::string Watchable::tagsToString() const {
-    std::string tagsString = "[";
-    for (const auto &tag: tags) {
-        if (tag != tags.back()) {
-            tagsString.append(tag).append(", ");
-        } else {
-            tagsString.append(tag).append("]");
-        }
-    }
-    return tagsString;
+std::string Watchable::tagsToString(const TagDictionary &dictionary) const {
+    return dictionary.toString(tags);
+}
+
+bool Watchable::checkInTags(TagId tag) const {
+    return TagDictionary::contains(tags, tagMask, tag);
 }
 
-bool Watchable::checkInTags(const std::string &tag) const {
-    return std::find(tags.begin(), tags.end(), tag) != tags.end();
+void Watchable::remapTags(const std::vector<TagId> &newIds) {
+    for (auto &tag : tags) {
+        tag = newIds[tag];
+    }
+    tagMask = TagDictionary::toMask(tags);
 }
 
 
 //MOVIE
-Movie::Movie(long id, const std::string &name, int length, const std::vector<std::string> &tags) : Watchable(id, length,
-                                                                                                             tags),
-                                                                                                   name(name) {}
+Movie::Movie(long id, const std::string &name, int length, const std::vector<TagId> &tags)
+        : Watchable(id, length, tags), name(name) {}
 
 Movie::Movie(Movie &movie) = default;
 
@@ -98,7 +97,7 @@ std::string Movie::getName() const {
 
 //EPISODE
 Episode::Episode(long id, const std::string &seriesName, int length, int season, int episode,
-                 const std::vector<std::string> &tags) : Watchable(id, length, tags), seriesName(seriesName),
+                 const std::vector<TagId> &tags) : Watchable(id, length, tags), seriesName(seriesName),
                                                          season(season), episode(episode),
                                                          nextEpisodeId(id + 1) {
 }
@@ -0,0 +1,89 @@
+#include "../include/WatchedSet.h"
+
+WatchedSet::WatchedSet() : sparse(), bits(), dense(false), count(0), maxId(0) {}
+
+void WatchedSet::add(long id) {
+    if (contains(id)) {
+        return;
+    }
+    count++;
+    if (id > maxId) {
+        maxId = id;
+    }
+    if (dense) {
+        addBit(id);
+        return;
+    }
+    sparse.insert(id);
+    if (count * SPARSE_ENTRY_BITS >= static_cast<std::size_t>(maxId)) {
+        toDense();
+    }
+}
+
+bool WatchedSet::contains(long id) const {
+    if (dense) {
+        auto word = static_cast<std::size_t>(id) / 64;
+        return id >= 0 && word < bits.size() && ((bits[word] >> (id % 64)) & 1);
+    }
+    return sparse.find(id) != sparse.end();
+}
+
+long WatchedSet::firstMissing(long first, long last) const {
+    long id = first;
+    while (id <= last) {
+        auto word = static_cast<std::size_t>(id) / 64;
+        if (!dense || word >= bits.size()) {
+            if (!contains(id)) {
+                return id;
+            }
+            id++;
+            continue;
+        }
+        //the unwatched bits of this word, starting at id
+        std::uint64_t missing = ~bits[word] >> (id % 64);
+        if (missing != 0) {
+            long found = id + __builtin_ctzll(missing);
+            return found <= last ? found : -1;
+        }
+        id = static_cast<long>(word + 1) * 64;
+    }
+    return -1;
+}
+
+std::size_t WatchedSet::size() const {
+    return count;
+}
+
+bool WatchedSet::isDense() const {
+    return dense;
+}
+
+std::vector<std::uint64_t> const &WatchedSet::getBits() const {
+    return bits;
+}
+
+void WatchedSet::clear() {
+    sparse.clear();
+    bits.clear();
+    dense = false;
+    count = 0;
+    maxId = 0;
+}
+
+//Private
+void WatchedSet::addBit(long id) {
+    auto word = static_cast<std::size_t>(id) / 64;
+    if (word >= bits.size()) {
+        bits.resize(word + 1, 0);
+    }
+    bits[word] |= std::uint64_t(1) << (id % 64);
+}
+
+void WatchedSet::toDense() {
+    dense = true;
+    bits.assign(static_cast<std::size_t>(maxId) / 64 + 1, 0);
+    for (long id : sparse) {
+        addBit(id);
+    }
+    std::unordered_set<long>().swap(sparse);
+}
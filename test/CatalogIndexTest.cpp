@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "Check.h"
+#include "../include/Catalog.h"
+#include "../include/CatalogIndex.h"
+#include "../include/ContentColumns.h"
+#include "../include/Watchable.h"
+#include "../include/WatchedSet.h"
+
+/**
+ * Checks the recommendation searches of the length and tag indexes and of the content columns against a
+ * brute force search, on random catalogs and watched sets, and the watched set against a std::set.
+ */
+
+//the length and the tags of every id, by brute force over the movies and the series
+struct Rows {
+    std::vector<int> lengths;
+    std::vector<std::vector<TagId>> tags;
+};
+
+static Rows rowsOf(const Catalog &catalog) {
+    Rows rows;
+    for (const Movie *movie : catalog.getMovies()) {
+        rows.lengths.push_back(movie->getLength());
+        rows.tags.push_back(movie->getTags());
+    }
+    for (const Series *series : catalog.getSeries()) {
+        for (long id = series->getFirstId(); id <= series->getLastId(); id++) {
+            rows.lengths.push_back(series->getEpisodeLength());
+            rows.tags.push_back(series->getTags());
+        }
+    }
+    return rows;
+}
+
+static void randomCatalog(Catalog &catalog, std::mt19937 &random, int movies, int series, int maxLength, int tags) {
+    std::uniform_int_distribution<int> length(1, maxLength);
+    std::uniform_int_distribution<int> tag(0, tags - 1);
+    std::uniform_int_distribution<int> small(1, 6);
+    for (int movie = 0; movie < movies; movie++) {
+        catalog.addMovie("movie", length(random), {"t" + std::to_string(tag(random)), "t" + std::to_string(tag(random))});
+    }
+    for (int show = 0; show < series; show++) {
+        std::vector<int> seasons(small(random));
+        for (int &episodes : seasons) {
+            episodes = small(random);
+        }
+        catalog.addSeries("series", length(random), seasons, {"t" + std::to_string(tag(random))});
+    }
+    catalog.finish();
+}
+
+static WatchedSet randomWatched(long ids, std::mt19937 &random) {
+    WatchedSet watched;
+    //from a few ids, which stay a hash set, to most of the ids, which turn into a bitmap
+    int percent = std::uniform_int_distribution<int>(0, 99)(random);
+    std::uniform_int_distribution<int> draw(0, 99);
+    for (long id = 1; id <= ids; id++) {
+        if (draw(random) < percent) {
+            watched.add(id);
+        }
+    }
+    return watched;
+}
+
+static void checkLengths(const Rows &rows, const LengthIndex &index, const ContentColumns &columns,
+                         const WatchedSet &watched, int average, std::size_t k) {
+    std::vector<std::pair<long, long>> candidates;
+    for (std::size_t row = 0; row < rows.lengths.size(); row++) {
+        auto id = static_cast<long>(row) + 1;
+        if (!watched.contains(id)) {
+            candidates.emplace_back(std::labs(static_cast<long>(rows.lengths[row]) - average), id);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    std::vector<long> expected;
+    for (std::size_t i = 0; i < candidates.size() && i < k; i++) {
+        expected.push_back(candidates[i].second);
+    }
+    long closest = expected.empty() ? -1 : expected[0];
+
+    std::string what = " average " + std::to_string(average) + " k " + std::to_string(k);
+    check(index.findClosest(average, watched) == closest, "LengthIndex::findClosest" + what);
+    check(columns.findClosestLength(average, watched) == closest, "ContentColumns::findClosestLength" + what);
+    check(index.findClosest(average, watched, k) == expected, "LengthIndex::findClosest top k" + what);
+    check(columns.findClosestLengths(average, watched, k) == expected, "ContentColumns::findClosestLengths" + what);
+}
+
+static void checkTags(const Rows &rows, const TagIndex &index, const ContentColumns &columns,
+                      const WatchedSet &watched, TagId first, TagId second, std::size_t k) {
+    //the ids of the first tag, then the ones of the second tag that are not taken yet
+    std::vector<long> expected;
+    for (TagId tag : {first, second}) {
+        for (std::size_t row = 0; row < rows.tags.size() && expected.size() < k; row++) {
+            auto id = static_cast<long>(row) + 1;
+            const auto &tags = rows.tags[row];
+            if (std::find(tags.begin(), tags.end(), tag) != tags.end() && !watched.contains(id) &&
+                std::find(expected.begin(), expected.end(), id) == expected.end()) {
+                expected.push_back(id);
+            }
+        }
+    }
+    long firstId = -1;
+    for (std::size_t row = 0; row < rows.tags.size() && firstId < 0; row++) {
+        auto id = static_cast<long>(row) + 1;
+        const auto &tags = rows.tags[row];
+        if (std::find(tags.begin(), tags.end(), first) != tags.end() && !watched.contains(id)) {
+            firstId = id;
+        }
+    }
+
+    std::string what = " tags " + std::to_string(first) + " " + std::to_string(second) + " k " + std::to_string(k);
+    check(index.findFirst(first, watched) == firstId, "TagIndex::findFirst" + what);
+    std::vector<long> collected;
+    index.collect(first, watched, k, collected);
+    index.collect(second, watched, k, collected);
+    check(collected == expected, "TagIndex::collect" + what);
+    //the columns only hold the tags of the masks
+    if (first < TagDictionary::MASK_BITS && second < TagDictionary::MASK_BITS) {
+        check(columns.findFirstWithTag(first, watched) == firstId, "ContentColumns::findFirstWithTag" + what);
+        collected.clear();
+        columns.collectWithTag(first, watched, k, collected);
+        columns.collectWithTag(second, watched, k, collected);
+        check(collected == expected, "ContentColumns::collectWithTag" + what);
+    }
+}
+
+static void checkWatchedSet(std::mt19937 &random) {
+    for (int round = 0; round < 20; round++) {
+        long ids = std::uniform_int_distribution<long>(1, 20000)(random);
+        std::uniform_int_distribution<long> id(1, ids);
+        WatchedSet watched;
+        std::set<long> expected;
+        bool becameDense = false;
+        long adds = std::uniform_int_distribution<long>(0, 2 * ids)(random);
+        for (long added = 0; added < adds; added++) {
+            long next = id(random);
+            watched.add(next);
+            expected.insert(next);
+            becameDense = becameDense || watched.isDense();
+            check(!becameDense || watched.isDense(), "WatchedSet stays dense");
+        }
+        check(watched.size() == expected.size(), "WatchedSet::size");
+        for (long probe = 0; probe <= ids + 64; probe++) {
+            if (watched.contains(probe) != (expected.count(probe) == 1)) {
+                check(false, "WatchedSet::contains " + std::to_string(probe));
+                break;
+            }
+        }
+        for (int query = 0; query < 50; query++) {
+            long first = id(random);
+            long last = std::min(ids, first + std::uniform_int_distribution<long>(0, 300)(random));
+            long missing = -1;
+            for (long candidate = first; candidate <= last && missing < 0; candidate++) {
+                if (!expected.count(candidate)) {
+                    missing = candidate;
+                }
+            }
+            check(watched.firstMissing(first, last) == missing,
+                  "WatchedSet::firstMissing " + std::to_string(first) + " " + std::to_string(last));
+        }
+        if (ids > 1000 && adds > ids) {
+            check(watched.isDense(), "WatchedSet of most ids is dense");
+        }
+        watched.clear();
+        check(watched.size() == 0 && !watched.contains(id(random)), "WatchedSet::clear");
+    }
+}
+
+int main() {
+    std::mt19937 random(11);
+    for (int round = 0; round < 24; round++) {
+        //small and large catalogs, short and long lengths, more tags than fit in a mask
+        bool large = round % 2 == 1;
+        int maxLength = round % 3 == 0 ? 300 : 30;
+        int tags = 80;
+        Catalog catalog;
+        randomCatalog(catalog, random, large ? 3000 : 100, large ? 300 : 10, maxLength, tags);
+        Rows rows = rowsOf(catalog);
+        check(static_cast<long>(rows.lengths.size()) == catalog.size(), "Catalog::size");
+
+        LengthIndex lengthIndex;
+        lengthIndex.build(catalog.getMovies(), catalog.getSeries());
+        TagIndex tagIndex;
+        tagIndex.build(catalog.getMovies(), catalog.getSeries(), catalog.getTagDictionary().size());
+        const ContentColumns &columns = catalog.getColumns();
+        check(columns.size() == rows.lengths.size(), "ContentColumns::size");
+        const MappedArray<int> &lengths = columns.getLengths();
+        check(std::vector<int>(lengths.begin(), lengths.end()) == rows.lengths, "ContentColumns::getLengths");
+
+        std::uniform_int_distribution<int> average(0, maxLength + 10);
+        std::uniform_int_distribution<std::size_t> k(1, 40);
+        std::uniform_int_distribution<TagId> tag(0, static_cast<TagId>(catalog.getTagDictionary().size() - 1));
+        for (int query = 0; query < 20; query++) {
+            WatchedSet watched = randomWatched(catalog.size(), random);
+            checkLengths(rows, lengthIndex, columns, watched, average(random), k(random));
+            checkTags(rows, tagIndex, columns, watched, tag(random), tag(random), k(random));
+        }
+    }
+    checkWatchedSet(random);
+    return checkResult();
+}
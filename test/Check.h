@@ -0,0 +1,29 @@
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <iostream>
+#include <string>
+
+/**
+ * The checks of a test program: a failed check is printed and counted, and the program exits with
+ * checkResult(), which is non zero if any check failed.
+ */
+inline int &checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void check(bool condition, const std::string &what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        checkFailures()++;
+    }
+}
+
+inline int checkResult() {
+    std::cerr << (checkFailures() == 0 ? "all checks passed" : std::to_string(checkFailures()) + " checks failed")
+              << std::endl;
+    return checkFailures() == 0 ? 0 : 1;
+}
+
+#endif
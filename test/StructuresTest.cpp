@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Check.h"
+#include "../include/Action.h"
+#include "../include/ActionLog.h"
+#include "../include/ActionStats.h"
+#include "../include/Catalog.h"
+#include "../include/CatalogSnapshot.h"
+#include "../include/CommandTable.h"
+#include "../include/Session.h"
+#include "../include/ThreadPool.h"
+#include "../include/User.h"
+#include "../include/Watchable.h"
+
+/**
+ * Checks the edge cases of the actions log ring buffer, its spill file and its strings, the percentiles of the
+ * action stats, the command table and the commands registered to the sessions, the rejection of stale and
+ * corrupted catalog snapshots, the catalog read in place from a snapshot, the invalidation of the recommendations
+ * cached by the users, the episodes created by concurrent sessions and the thread pool.
+ */
+
+static std::string readFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+static void writeFile(const std::string &path, const std::string &content) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << content;
+}
+
+//the line of the log for a user created by createUser
+static std::string createLine(int user) {
+    return CreateUser("user" + std::to_string(user), "len").toString() + "\n";
+}
+
+static void createUser(ActionLog &log, int user) {
+    log.add(CreateUser("user" + std::to_string(user), "len"));
+}
+
+static void checkActionLogRing() {
+    const std::string spillPath = "structures-test.spill";
+    std::remove(spillPath.c_str());
+    ActionLog log;
+    log.setCapacity(5);
+    check(log.setSpillPath(spillPath), "ActionLog::setSpillPath");
+    for (int user = 0; user < 12; user++) {
+        createUser(log, user);
+    }
+    std::string kept;
+    for (int user = 7; user < 12; user++) {
+        kept += createLine(user);
+    }
+    check(log.size() == 5, "ActionLog keeps its capacity");
+    check(log.toString() == kept, "ActionLog keeps the newest records, oldest first");
+
+    //shrinking evicts the oldest records, growing keeps all of them again
+    log.setCapacity(3);
+    check(log.size() == 3, "ActionLog::setCapacity shrinks");
+    createUser(log, 12);
+    log.setCapacity(ActionLog::UNBOUNDED);
+    createUser(log, 13);
+    createUser(log, 14);
+    std::string rest;
+    for (int user = 10; user < 15; user++) {
+        rest += createLine(user);
+    }
+    check(log.toString() == rest, "ActionLog after setCapacity");
+    std::ostringstream range;
+    log.write(range, 1, 2);
+    check(range.str() == createLine(11) + createLine(12), "ActionLog::write of a range");
+
+    std::string spilled;
+    for (int user = 0; user < 10; user++) {
+        spilled += createLine(user);
+    }
+    log = ActionLog();
+    check(readFile(spillPath) == spilled, "ActionLog spills the evicted records in order");
+    std::remove(spillPath.c_str());
+}
+
+static void checkActionLogStrings() {
+    //every record has new names, like the duplicates of a replayed workload
+    ActionLog log;
+    log.setCapacity(10);
+    std::size_t mostStrings = 0;
+    for (int copy = 0; copy < 100000; copy++) {
+        std::string user = "user" + std::to_string(copy % 7);
+        std::string name = "copy" + std::to_string(copy);
+        log.add(DuplicateUser(user, name));
+        if (copy % 3 == 0) {
+            log.add(CreateUser(name, "gen"));
+        }
+        mostStrings = std::max(mostStrings, log.getStrings().size());
+    }
+    //at most two strings per kept record, and the ids of released strings are reused
+    check(mostStrings <= 2 * 10 + 2, "ActionLog strings stay bounded, " + std::to_string(mostStrings) + " ids");
+
+    std::string kept;
+    for (std::size_t position = 0; position < log.size(); position++) {
+        log.appendLine(kept, position);
+    }
+    std::string expected;
+    for (int copy = 99992; copy < 100000; copy++) {
+        std::string user = "user" + std::to_string(copy % 7);
+        std::string name = "copy" + std::to_string(copy);
+        expected += DuplicateUser(user, name).toString() + "\n";
+        if (copy % 3 == 0) {
+            expected += CreateUser(name, "gen").toString() + "\n";
+        }
+    }
+    expected = expected.substr(expected.size() - kept.size());
+    check(kept == expected, "ActionLog records keep their strings when ids are reused");
+
+    //an unbounded log keeps all of them
+    log.setCapacity(ActionLog::UNBOUNDED);
+    for (int user = 0; user < 100; user++) {
+        createUser(log, user);
+    }
+    check(log.size() == 110 && log.toString().find(createLine(0)) != std::string::npos, "ActionLog unbounded again");
+}
+
+//loads a snapshot into an empty catalog and counts its ids, a rejected snapshot must leave the catalog empty
+static bool loads(const std::string &snapshotPath, const std::string &configPath, int &entries) {
+    Catalog catalog;
+    bool loaded = CatalogSnapshot::load(snapshotPath, configPath, catalog);
+    entries = static_cast<int>(catalog.size());
+    return loaded;
+}
+
+static void checkSnapshotRejection() {
+    const std::string configPath = "structures-test.json";
+    const std::string snapshotPath = CatalogSnapshot::pathFor(configPath);
+    const std::string corruptPath = "structures-test-corrupt.snap";
+    writeFile(configPath, "{\"movies\": [{\"name\": \"A\", \"length\": 90, \"tags\": [\"x\", \"y\"]},"
+                          " {\"name\": \"B\", \"length\": 100, \"tags\": [\"y\"]}],"
+                          " \"tv_series\": [{\"name\": \"C\", \"episode_length\": 30, \"seasons\": [2, 3],"
+                          " \"tags\": [\"x\"]}]}");
+    check(CatalogSnapshot::write(configPath, snapshotPath), "CatalogSnapshot::write");
+    int entries;
+    check(loads(snapshotPath, configPath, entries) && entries == 7, "CatalogSnapshot::load");
+
+    const std::string image = readFile(snapshotPath);
+    //the offsets of the magic, the version and the header size in the header, and a byte of the payload
+    const std::size_t offsets[] = {0, 8, 12, image.size() - 1};
+    const char *names[] = {"magic", "version", "header size", "payload"};
+    for (int corruption = 0; corruption < 4; corruption++) {
+        std::string corrupt = image;
+        corrupt[offsets[corruption]] ^= 0x5a;
+        writeFile(corruptPath, corrupt);
+        check(!loads(corruptPath, configPath, entries) && entries == 0,
+              std::string("CatalogSnapshot rejects a corrupted ") + names[corruption]);
+    }
+    writeFile(corruptPath, image.substr(0, image.size() / 2));
+    check(!loads(corruptPath, configPath, entries) && entries == 0, "CatalogSnapshot rejects a truncated file");
+    writeFile(corruptPath, image.substr(0, 10));
+    check(!loads(corruptPath, configPath, entries) && entries == 0, "CatalogSnapshot rejects a partial header");
+    check(!loads("structures-test-missing.snap", configPath, entries), "CatalogSnapshot of a missing file");
+
+    //a snapshot of an older config file is stale
+    std::ofstream(configPath, std::ios::app) << " ";
+    check(!loads(snapshotPath, configPath, entries) && entries == 0, "CatalogSnapshot rejects a stale snapshot");
+
+    std::remove(corruptPath.c_str());
+    std::remove(snapshotPath.c_str());
+    std::remove(configPath.c_str());
+}
+
+static void checkSnapshotCatalog() {
+    //enough episodes for the indexes, and tags that are not in lexicographic order in the file
+    const std::string configPath = "structures-test-indexed.json";
+    const std::string snapshotPath = CatalogSnapshot::pathFor(configPath);
+    std::string movies;
+    for (int movie = 0; movie < 300; movie++) {
+        movies += std::string(movie == 0 ? "" : ", ") + "{\"name\": \"M" + std::to_string(movie) + "\", \"length\": " +
+                  std::to_string(60 + movie % 70) + ", \"tags\": [\"t" + std::to_string(movie % 11) + "\", \"a" +
+                  std::to_string(movie % 5) + "\"]}";
+    }
+    writeFile(configPath, "{\"movies\": [" + movies + "], \"tv_series\": ["
+                          "{\"name\": \"S\", \"episode_length\": 40, \"seasons\": [2000, 0, 1500],"
+                          " \"tags\": [\"t3\"]},"
+                          " {\"name\": \"T\", \"episode_length\": 95, \"seasons\": [1000],"
+                          " \"tags\": [\"z\", \"a1\"]}]}");
+    Catalog fromJson;
+    CatalogLoader::loadJson(configPath, fromJson);
+    check(CatalogSnapshot::write(configPath, snapshotPath), "CatalogSnapshot::write of an indexed catalog");
+    auto *mapped = new Catalog();
+    check(CatalogSnapshot::load(snapshotPath, configPath, *mapped) && mapped->isIndexed(),
+          "CatalogSnapshot::load of an indexed catalog");
+    //a copy shares the mapping, which must outlive the catalog it was loaded into
+    Catalog fromSnapshot(*mapped);
+    delete mapped;
+
+    check(fromSnapshot.size() == fromJson.size() && fromSnapshot.toString() == fromJson.toString(),
+          "CatalogSnapshot keeps the content");
+    const ContentColumns &columns = fromSnapshot.getColumns();
+    const ContentColumns &built = fromJson.getColumns();
+    check(std::equal(columns.getLengths().begin(), columns.getLengths().end(), built.getLengths().begin()) &&
+          std::equal(columns.getTagMasks().begin(), columns.getTagMasks().end(), built.getTagMasks().begin()),
+          "CatalogSnapshot keeps the columns");
+    WatchedSet watched;
+    for (long id = 1; id <= fromJson.size(); id += 3) {
+        watched.add(id);
+    }
+    bool same = true;
+    for (int average = 0; average < 140; average += 7) {
+        same = same && fromSnapshot.findClosestLengths(average, watched, 25) ==
+                       fromJson.findClosestLengths(average, watched, 25);
+    }
+    for (TagId tag = 0; tag < fromJson.getTagDictionary().size(); tag++) {
+        std::vector<long> mappedIds;
+        std::vector<long> builtIds;
+        fromSnapshot.collectWithTag(tag, watched, 40, mappedIds);
+        fromJson.collectWithTag(tag, watched, 40, builtIds);
+        same = same && mappedIds == builtIds &&
+               fromSnapshot.getTagDictionary().getTag(tag) == fromJson.getTagDictionary().getTag(tag);
+    }
+    check(same, "CatalogSnapshot keeps the indexes");
+
+    std::remove(snapshotPath.c_str());
+    std::remove(configPath.c_str());
+}
+
+static std::vector<long> idsOf(const std::vector<Watchable *> &recommendations) {
+    std::vector<long> ids;
+    for (const Watchable *recommendation : recommendations) {
+        ids.push_back(recommendation->getId());
+    }
+    return ids;
+}
+
+static void checkRecommendationCache() {
+    std::mt19937 random(5);
+    //a tiny catalog that the users watch almost entirely, a small one that is scanned and an indexed one
+    for (int movies : {12, 200, 5000}) {
+        auto catalog = std::make_shared<Catalog>();
+        std::uniform_int_distribution<int> length(20, 40);
+        std::uniform_int_distribution<int> tag(0, 5);
+        for (int movie = 0; movie < movies; movie++) {
+            catalog->addMovie("M" + std::to_string(movie), length(random),
+                              {"t" + std::to_string(tag(random)), "t" + std::to_string(tag(random))});
+        }
+        catalog->addSeries("S", 30, {3, 4}, {"t" + std::to_string(tag(random))});
+        catalog->finish();
+        Session sess(catalog);
+        std::string names[] = {"len", "rer", "gen"};
+        std::vector<User *> users = {new LengthRecommenderUser(names[0]), new RerunRecommenderUser(names[1]),
+                                     new GenreRecommenderUser(names[2])};
+        for (int user = 0; user < 3; user++) {
+            sess.addUser(names[user], users[user]);
+        }
+
+        std::uniform_int_distribution<long> id(1, catalog->size());
+        std::uniform_int_distribution<std::size_t> k(1, 12);
+        std::uniform_int_distribution<int> percent(0, 99);
+        bool same = true;
+        for (int step = 0; step < 300 && same; step++) {
+            User *user = users[step % 3];
+            //fill the cache with a top k, or a single recommendation, then watch one of them or any content
+            std::vector<Watchable *> cached = user->getRecommendations(sess, k(random));
+            if (percent(random) < 30) {
+                user->getRecommendation(sess);
+            }
+            Watchable *watched = sess.getWatchable(id(random));
+            if (!cached.empty() && percent(random) < 50) {
+                watched = cached[std::uniform_int_distribution<std::size_t>(0, cached.size() - 1)(random)];
+            }
+            user->addToHistory(watched);
+
+            std::string cloneName = "clone";
+            std::unique_ptr<User> fresh(user->clone(cloneName));
+            std::size_t asked = k(random);
+            std::vector<long> cachedIds = idsOf(user->getRecommendations(sess, asked));
+            same = cachedIds == idsOf(fresh->getRecommendations(sess, asked));
+            Watchable *first = user->getRecommendation(sess);
+            same = same && (cachedIds.empty() ? first == nullptr : first->getId() == cachedIds.front());
+            check(same, "User recommendations cached like a fresh clone, " + user->getName() + " step " +
+                        std::to_string(step) + " k " + std::to_string(asked) + ", " + std::to_string(movies) +
+                        " movies");
+        }
+    }
+}
+
+static void checkSharedEpisodes() {
+    Catalog catalog;
+    catalog.addSeries("S", 30, {40, 4000}, {"t"});
+    catalog.finish();
+    //every thread asks for every episode, in an order of its own, and must get the episode the others got
+    const int threads = 8;
+    std::vector<std::vector<Watchable *>> seen(threads, std::vector<Watchable *>(catalog.size() + 1));
+    std::vector<std::thread> readers;
+    std::atomic<int> ready(0);
+    for (int thread = 0; thread < threads; thread++) {
+        readers.emplace_back([&catalog, &seen, &ready, thread]() {
+            //start together, so the first calls race
+            ready++;
+            while (ready < threads) {
+            }
+            for (int round = 0; round < 3; round++) {
+                for (long id = 1; id <= catalog.size(); id++) {
+                    long asked = thread % 2 ? id : catalog.size() + 1 - id;
+                    seen[thread][asked] = catalog.getWatchable(asked);
+                }
+            }
+        });
+    }
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+    bool same = true;
+    for (long id = 1; id <= catalog.size(); id++) {
+        for (int thread = 0; thread < threads; thread++) {
+            same = same && seen[thread][id] == seen[0][id] && seen[thread][id]->getId() == id;
+        }
+    }
+    check(same, "Series creates every episode once for concurrent sessions");
+    check(seen[0][41]->toString() == "S S2E1", "Series::getEpisode locates the episode");
+}
+
+static void checkThreadPool() {
+    for (std::size_t threads : {1, 2, 4}) {
+        ThreadPool pool(threads);
+        check(pool.size() == threads, "ThreadPool::size");
+        for (std::size_t count : {0, 1, 7, 1000, 100000}) {
+            std::vector<int> runs(count, 0);
+            pool.forEach(count, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t index = begin; index < end; index++) {
+                    runs[index]++;
+                }
+            });
+            bool once = true;
+            for (int run : runs) {
+                once = once && run == 1;
+            }
+            check(once, "ThreadPool::forEach runs every index once, " + std::to_string(threads) + " threads, " +
+                        std::to_string(count) + " indexes");
+        }
+
+        //an exception of a task reaches the caller, and the pool still runs the next loop
+        bool thrown = false;
+        try {
+            pool.forEach(1000, [](std::size_t begin, std::size_t) {
+                if (begin >= 500) {
+                    throw std::runtime_error("task failed");
+                }
+            });
+        } catch (const std::runtime_error &error) {
+            thrown = std::string(error.what()) == "task failed";
+        }
+        check(thrown, "ThreadPool::forEach rethrows, " + std::to_string(threads) + " threads");
+        std::atomic<std::size_t> sum(0);
+        pool.forEach(100, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t index = begin; index < end; index++) {
+                sum += index;
+            }
+        });
+        check(sum == 4950, "ThreadPool::forEach after an exception");
+    }
+}
+
+//runs first, before anything else records stats
+static void checkActionStats() {
+    check(ActionStats::toString(1).empty(), "ActionStats is empty before recording");
+    //500 actions in the bucket of [2, 4), 490 in [64, 128), 9 in [512, 1024) recorded by another thread and a maximum
+    for (int action = 0; action < 500; action++) {
+        ActionStats::record(WATCH, 3);
+    }
+    for (int action = 0; action < 490; action++) {
+        ActionStats::record(WATCH, 100);
+    }
+    std::thread other([]() {
+        for (int action = 0; action < 9; action++) {
+            ActionStats::record(WATCH, 600);
+        }
+    });
+    other.join();
+    ActionStats::record(WATCH, 5000);
+    ActionStats::record(CREATE_USER, 0);
+    //the bucket of [4, 8) is capped at the maximum
+    ActionStats::record(EXIT, 6);
+    ActionStats::record(EXIT, 5);
+    //the rank of a percentile rounds up, the median of 3 actions is the second
+    ActionStats::record(RECOMMEND, 1);
+    ActionStats::record(RECOMMEND, 40);
+    ActionStats::record(RECOMMEND, 200);
+    std::string expected = "createuser: 1 actions, p50 0 ns, p99 0 ns, p999 0 ns, max 0 ns\n"
+                           "watch: 1000 actions, p50 3 ns, p99 127 ns, p999 1023 ns, max 5000 ns\n"
+                           "exit: 2 actions, p50 6 ns, p99 6 ns, p999 6 ns, max 6 ns\n"
+                           "recommend: 3 actions, p50 63 ns, p99 200 ns, p999 200 ns, max 200 ns\n";
+    check(ActionStats::toString(1) == expected, "ActionStats percentiles are the upper bounds of their buckets");
+    check(ActionStats::toString(2).find("watch: 1000 actions, p50 6 ns, p99 254 ns") != std::string::npos,
+          "ActionStats scales ticks to nanoseconds");
+}
+
+static int dispatched = 0;
+static Session *dispatchedTo = nullptr;
+
+static void countDispatch(Session &sess) {
+    dispatched++;
+    dispatchedTo = &sess;
+}
+
+static void ignoreDispatch(Session &) {}
+
+static void checkCommandTable() {
+    CommandTable table;
+    check(!table.add("", countDispatch) && !table.find(""), "CommandTable rejects an empty name");
+    check(table.add("watch", countDispatch), "CommandTable::add");
+    check(!table.add("watch", ignoreDispatch) && table.find("watch") == countDispatch,
+          "CommandTable rejects a duplicate name and keeps the first handler");
+    //same first characters and length, so the same slot: the second one probes to the next slot
+    check(CommandTable::slotOf("wazzz", 5) == CommandTable::slotOf("watch", 5), "wazzz collides with watch");
+    check(table.add("wazzz", ignoreDispatch) && table.find("wazzz") == ignoreDispatch &&
+          table.find("watch") == countDispatch, "CommandTable probes a colliding name");
+    check(!table.find("waxxx"), "CommandTable misses a colliding name it does not have");
+    //both in the last slot, the second wraps around to the first slot
+    check(CommandTable::slotOf("am", 2) == CommandTable::SLOTS - 1 &&
+          CommandTable::slotOf("a]", 2) == CommandTable::SLOTS - 1, "am and a] are in the last slot");
+    check(table.add("am", countDispatch) && table.add("a]", ignoreDispatch) && table.find("am") == countDispatch &&
+          table.find("a]") == ignoreDispatch, "CommandTable probes around the end of the table");
+
+    CommandTable full;
+    bool added = true;
+    for (std::size_t command = 0; command < CommandTable::SLOTS; command++) {
+        added = full.add("c" + std::to_string(command), countDispatch) && added;
+    }
+    check(added, "CommandTable takes a command in every slot");
+    check(!full.add("more", countDispatch), "CommandTable rejects a command when it is full");
+    bool found = true;
+    for (std::size_t command = 0; command < CommandTable::SLOTS; command++) {
+        found = full.find("c" + std::to_string(command)) == countDispatch && found;
+    }
+    check(found && !full.find("more"), "CommandTable finds every command of a full table and misses the others");
+}
+
+//registers to the commands of every session, so no other check may run a command named wazzz
+static void checkRegisteredCommand() {
+    check(!Session::registerCommand("", countDispatch), "Session::registerCommand rejects an empty name");
+    check(!Session::registerCommand("watch", countDispatch), "Session::registerCommand rejects a built in name");
+    check(Session::registerCommand("wazzz", countDispatch), "Session::registerCommand of a name that probes");
+    check(!Session::registerCommand("wazzz", ignoreDispatch), "Session::registerCommand rejects a duplicate name");
+
+    auto catalog = std::make_shared<Catalog>();
+    catalog->addMovie("M", 30, {"t"});
+    catalog->finish();
+    Session sess(catalog);
+    sess.setInteractive(false);
+    std::istringstream input("wazzz\nwaxxx\nwazzz\n");
+    std::ostringstream output;
+    std::streambuf *in = std::cin.rdbuf(input.rdbuf());
+    std::streambuf *out = std::cout.rdbuf(output.rdbuf());
+    sess.begin();
+    bool stepped = sess.step() && sess.step() && sess.step();
+    std::cin.rdbuf(in);
+    std::cout.rdbuf(out);
+    check(stepped && dispatched == 2 && dispatchedTo == &sess, "Session dispatches a registered command");
+    check(output.str().find("'waxxx' is not a valid command") != std::string::npos,
+          "Session rejects a command that is not registered");
+}
+
+int main() {
+    checkActionStats();
+    checkCommandTable();
+    checkRegisteredCommand();
+    checkActionLogRing();
+    checkActionLogStrings();
+    checkSnapshotRejection();
+    checkSnapshotCatalog();
+    checkRecommendationCache();
+    checkSharedEpisodes();
+    checkThreadPool();
+    return checkResult();
+}